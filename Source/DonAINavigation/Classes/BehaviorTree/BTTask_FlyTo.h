@@ -51,9 +51,24 @@ struct FBT_FlyToTarget
 
 	FDonNavigationDynamicCollisionDelegate DynamicCollisionListener;
 
+	/** Manager the pawn was last found in. Kept across Reset(), it only changes when the pawn leaves that manager's world */
+	TWeakObjectPtr<ADonNavigationManager> CachedNavigationManager;
+
 	int32 solutionTraversalIndex = 0;
 
-	FDoNNavigationQueryData QueryResults;
+	/** Distance travelled along the path spline, if the path has one (see FDonNavigationPathResult::Spline) */
+	float SplineDistance = 0.f;
+
+	EDonNavigationQueryStatus QueryStatus = EDonNavigationQueryStatus::Unscheduled;
+
+	/** Path being followed, shared with the navigation manager's result (see FDoNNavigationQueryData::Result) */
+	FDonNavigationPathResultPtr QueryResults;
+
+	const TArray<FVector>& Path() const
+	{
+		static const TArray<FVector> NoPath;
+		return QueryResults.IsValid() ? QueryResults->Path : NoPath;
+	}
 
 	bool bSolutionInvalidatedByDynamicObstacle = false;	
 
@@ -70,16 +85,22 @@ struct FBT_FlyToTarget
 
 	uint32 bTargetLocationChanged : 1;
 
+	/* Remaining distance to the goal at the end of the last partial path followed, re-querying from there must get us closer */
+	float PartialPathRemainingDistance = TNumericLimits<float>::Max();
+
 	void Reset()
 	{	
 		isMovingTargetRepath = false;
 		solutionTraversalIndex = 0;
-		QueryResults = FDoNNavigationQueryData();
+		SplineDistance = 0.f;
+		QueryStatus = EDonNavigationQueryStatus::Unscheduled;
+		QueryResults.Reset();
 		QueryParams = FDoNNavigationQueryParams();
 		Metadata = FBT_FlyToTarget_Metadata();
 		bSolutionInvalidatedByDynamicObstacle = false;
 		bTargetLocationChanged = false;
 		TargetActor = nullptr;
+		PartialPathRemainingDistance = TNumericLimits<float>::Max();
 	}
 };
 
@@ -125,6 +146,10 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "DoN Navigation")
 	float MinimumProximityRequired = 15.f;
 
+	/** When following a path spline (see FDoNNavigationQueryParams::bBuildPathSpline), the pawn steers towards the point this far ahead of it on the spline */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "DoN Navigation", meta = (ClampMin = 1))
+	float SplineLookAheadDistance = 100.f;
+
 	// Venu's Note:- Code for repath tolerance below was kindly contributed by Vladimir Ivanov (Github @ArCorvus). Thank you Vladimir!
 	//
 	/** Recalculate path enable */
@@ -166,12 +191,14 @@ protected:
 
 	FBT_FlyToTarget* TaskMemoryFromGenericPayload(void* GenericPayload);
 
-	EBTNodeResult::Type SchedulePathfindingRequest(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, bool isMovingTargetRepath = false);	
+	EBTNodeResult::Type SchedulePathfindingRequest(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, bool isMovingTargetRepath = false, bool bRepairPath = false);	
 
 	void AbortPathfindingRequest(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory);
 
 	void TickPathNavigation(UBehaviorTreeComponent& OwnerComp, FBT_FlyToTarget* MyMemory, float DeltaSeconds);
 
+	ADonNavigationManager* NavigationManagerForPawn(APawn* Pawn, FBT_FlyToTarget* MyMemory);
+
 	bool CheckTargetMoved(FBT_FlyToTarget* MyMemory);
 
 	virtual void OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult) override;
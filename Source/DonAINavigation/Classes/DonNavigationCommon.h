@@ -18,9 +18,6 @@
 #include <queue>
 #include <vector>
 
-#if PLATFORM_WINDOWS
-#include "Windows/AllowWindowsPlatformTypes.h"
-#endif
 
 
 namespace DoNNavigation
@@ -48,37 +45,8 @@ namespace DoNNavigation
 	// Eg: For profiling initial collision sampling on map load, etc
 	static FORCEINLINE uint64 Debug_GetTimeMs64()
 	{
-#if PLATFORM_WINDOWS
-		/* Windows */
-		FILETIME ft;
-		LARGE_INTEGER li;
-
-		/* Get the amount of 100 nano seconds intervals elapsed since January 1, 1601 (UTC) and copy it
-		* to a LARGE_INTEGER structure. */
-		GetSystemTimeAsFileTime(&ft);
-		li.LowPart = ft.dwLowDateTime;
-		li.HighPart = ft.dwHighDateTime;
-
-		uint64 ret = li.QuadPart;
-		ret -= 116444736000000000LL; /* Convert from file time to UNIX epoch time. */
-		ret /= 10000; /* From 100 nano seconds (10^-7) to 1 millisecond (10^-3) intervals */
-
-		return ret;
-#else
-		/* Linux */
-		struct timeval tv;
-
-		gettimeofday(&tv, NULL);
-
-		uint64 ret = tv.tv_usec;
-		/* Convert from micro seconds (10^-6) to milliseconds (10^-3) */
-		ret /= 1000;
-
-		/* Adds the seconds (10^0) after converting them to milliseconds (10^-3) */
-		ret += (tv.tv_sec * 1000);
-
-		return ret;
-#endif
+		// Monotonic, high resolution (the wall clock can jump and only had millisecond resolution on some platforms)
+		return (uint64)FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
 	}
 
 	uint64 FORCEINLINE Debug_GetTimer()
@@ -92,6 +60,3 @@ namespace DoNNavigation
 	}
 }
 
-#if PLATFORM_WINDOWS
- #include "Windows/HideWindowsPlatformTypes.h"
- #endif
@@ -15,10 +15,16 @@
 #pragma once
 
 #include "DonNavigationCommon.h"
+#include "DonNavigationPathSpline.h"
 #include "Multithreading/DonDrawDebugThreadSafe.h"
 #include "CollisionQueryParams.h"
 #include "WorldCollision.h"
 #include "Containers/Queue.h"
+#include "Containers/LockFreeList.h"
+#include "Containers/List.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeBool.h"
 #include "Components/BoxComponent.h"
 
 #include "DonNavigationManager.generated.h"
@@ -33,10 +39,28 @@ enum class EDonNavigationQueryStatus : uint8
 	Success,
 	Failure,
 	QueryHasNoSolution,
-	TimedOut
+	TimedOut,
+	PartialSuccess	// the query timed out or has no solution, but returned a path to the explored location nearest to the destination (see FDoNNavigationQueryParams::bAllowPartialPath)
 };
 
-struct FDonNavigationDynamicCollisionNotifyee;
+/** Scheduling class of a pathfinding query. Each class weighs twice the one below it when the solver's budget is shared out */
+UENUM(BlueprintType)
+enum class EDonNavigationQueryPriority : uint8
+{
+	Background,
+	Normal,
+	High,
+	Critical,
+	Num UMETA(Hidden)
+};
+
+/** Search algorithm used to solve a pathfinding query */
+UENUM(BlueprintType)
+enum class EDonNavigationSolverMode : uint8
+{
+	AStar,			// A* over the voxel grid. The path zig-zags between voxel centers until the optimizer straightens it
+	LazyThetaStar	// Any-angle search: nodes link straight to their parent's parent whenever the grid allows it, so paths come out near-taut. Bound worlds only
+};
 
 /**
 * This is the basic unit of pathfinding for Finite Worlds.
@@ -54,8 +78,15 @@ struct FDonNavigationVoxel
 	FVector Location;
 	uint8 NumResidents = 0;
 	bool bIsInitialized = false;
-	
-	TArray<FDonNavigationDynamicCollisionNotifyee> DynamicCollisionNotifyees;
+
+	/** Chebyshev distance (in voxels) to the nearest obstacle or world boundary, capped at the manager's MaxClearanceVoxels. Lazily computed. */
+	uint8 Clearance = ClearanceUnknown;
+
+	static const uint8 ClearanceUnknown = 0xFF;
+
+	/** One bit per agent size class layer (see ADonNavigationManager::AgentSizeClasses). A layer bit is only meaningful while its known bit is set. */
+	uint8 LayerKnownMask = 0;
+	uint8 LayerNavigableMask = 0;
 
 	bool FORCEINLINE CanNavigate() { return NumResidents == 0; }
 
@@ -67,8 +98,6 @@ struct FDonNavigationVoxel
 			NumResidents = NumResidents > 0 ? NumResidents - 1 : 0;
 	}
 	
-	void BroadcastCollisionUpdates();
-	
 	friend bool operator== (const FDonNavigationVoxel& A, const FDonNavigationVoxel& B)
 	{
 		return A.X == B.X && A.Y == B.Y && A.Z == B.Z;
@@ -77,6 +106,25 @@ struct FDonNavigationVoxel
 	FDonNavigationVoxel(){}	
 };
 
+/** A voxel offset relative to a mesh's origin voxel. Offsets are whole voxels, so 16 bits per axis are plenty (and 4x smaller than an FVector) */
+struct FDonVoxelOffset
+{
+	int16 X;
+	int16 Y;
+	int16 Z;
+
+	FDonVoxelOffset() : X(0), Y(0), Z(0) {}
+
+	FDonVoxelOffset(int32 InX, int32 InY, int32 InZ) : X((int16)InX), Y((int16)InY), Z((int16)InZ) {}
+
+	friend bool operator== (const FDonVoxelOffset& A, const FDonVoxelOffset& B)
+	{
+		return A.X == B.X && A.Y == B.Y && A.Z == B.Z;
+	}
+};
+
+typedef TArray<FDonVoxelOffset> FDonVoxelOffsetList;
+
 /*
 * Approximates the collision geometry of a mesh in the form of voxels.
 * This is only used when a pawn's collision body exceeds exceeds a "unit voxel volume" for the world.
@@ -88,15 +136,74 @@ struct FDonVoxelCollisionProfile
 {
 	GENERATED_USTRUCT_BODY()
 	
-	TArray<FVector> RelativeVoxelOccupancy;	
+	/**
+	* Offsets are immutable once sampled and shared by every cache entry, query and collision task using this profile,
+	* so copying a profile around only costs a reference count bump instead of a deep copy.
+	*/
+	TSharedPtr<const FDonVoxelOffsetList, ESPMode::ThreadSafe> RelativeVoxelOccupancy;
 
 	/** 
-	* Note:- These references are only valid so long as NAVVolumeData (see ADonNavigationManager) is not modified in any way.
-	* Presently, NAVVolumeData is populated once and only once (at the beginning of the game) and with this model, the references are safe to rely upon.
-	*/	
+	* The voxel this profile was last stamped onto the world from (see DynamicCollisionUpdateForMesh). The occupied voxels are re-derived from 
+	* this and the offsets above instead of storing a pointer per occupied voxel.
+	*/
+	int32 WorldOriginX = 0;
+	int32 WorldOriginY = 0;
+	int32 WorldOriginZ = 0;
+	bool bOccupiesWorld = false;
+
+	/** Bounding box of the offsets and the largest offset along any axis, i.e. the clearance (in voxels) a pawn with this profile needs */
+	FDonVoxelOffset OffsetsMin;
+	FDonVoxelOffset OffsetsMax;
+	uint8 ChebyshevRadius = 0;
+
+	FORCEINLINE const FDonVoxelOffsetList& Offsets() const { return RelativeVoxelOccupancy.IsValid() ? *RelativeVoxelOccupancy : EmptyOffsets(); }
+
+	FORCEINLINE int32 Num() const { return RelativeVoxelOccupancy.IsValid() ? RelativeVoxelOccupancy->Num() : 0; }
+
+	/** Whether both profiles occupy the same voxels. Profiles are cached per mesh, so identically sized pawns have equal offsets behind different pointers */
+	bool HasSameOffsets(const FDonVoxelCollisionProfile& Other) const
+	{
+		if (RelativeVoxelOccupancy == Other.RelativeVoxelOccupancy)
+			return true;
+
+		if (Num() != Other.Num() || ChebyshevRadius != Other.ChebyshevRadius || !(OffsetsMin == Other.OffsetsMin) || !(OffsetsMax == Other.OffsetsMax))
+			return false;
+
+		return Offsets() == Other.Offsets();
+	}
+
+	void SetOffsets(FDonVoxelOffsetList&& InOffsets)
+	{
+		OffsetsMin = OffsetsMax = FDonVoxelOffset();
+		int32 radius = 0;
+
+		for (const FDonVoxelOffset& offset : InOffsets)
+		{
+			OffsetsMin = FDonVoxelOffset(FMath::Min(OffsetsMin.X, offset.X), FMath::Min(OffsetsMin.Y, offset.Y), FMath::Min(OffsetsMin.Z, offset.Z));
+			OffsetsMax = FDonVoxelOffset(FMath::Max(OffsetsMax.X, offset.X), FMath::Max(OffsetsMax.Y, offset.Y), FMath::Max(OffsetsMax.Z, offset.Z));
+			radius = FMath::Max(radius, FMath::Max3(FMath::Abs((int32)offset.X), FMath::Abs((int32)offset.Y), FMath::Abs((int32)offset.Z)));
+		}
+
+		ChebyshevRadius = (uint8)FMath::Min(radius, 255);
 
-	TArray<FDonNavigationVoxel*> WorldVoxelsOccupied;
+		InOffsets.Shrink();
+		RelativeVoxelOccupancy = MakeShared<FDonVoxelOffsetList, ESPMode::ThreadSafe>(MoveTemp(InOffsets));
+	}
 
+	void SetWorldOrigin(const FDonNavigationVoxel& Volume)
+	{
+		WorldOriginX = Volume.X;
+		WorldOriginY = Volume.Y;
+		WorldOriginZ = Volume.Z;
+		bOccupiesWorld = true;
+	}
+
+private:
+	static const FDonVoxelOffsetList& EmptyOffsets()
+	{
+		static const FDonVoxelOffsetList Empty;
+		return Empty;
+	}
 };
 
 /** 
@@ -110,11 +217,18 @@ struct FDonNavigationDynamicCollisionPayload
 	
 	void* CustomDelegatePayload;	
 	
+	/** First of the newly occupied voxels along the path */
 	FDonNavigationVoxel Voxel;
 
+	/** Every index of the path (see FDonNavigationPathResult::PathVolumes) obstructed since the last broadcast, in ascending order. Listeners are notified at most once per tick */
+	UPROPERTY(BlueprintReadOnly, Category = "DoN Navigation")
+	TArray<int32> AffectedPathIndices;
+
 	FDonNavigationDynamicCollisionPayload(){}
 
 	FDonNavigationDynamicCollisionPayload(void* CustomDelegatePayloadIn, FDonNavigationVoxel VoxelIn) : CustomDelegatePayload(CustomDelegatePayloadIn), Voxel(VoxelIn) {}
+
+	FDonNavigationDynamicCollisionPayload(void* CustomDelegatePayloadIn, FDonNavigationVoxel VoxelIn, TArray<int32>&& AffectedPathIndicesIn) : CustomDelegatePayload(CustomDelegatePayloadIn), Voxel(VoxelIn), AffectedPathIndices(MoveTemp(AffectedPathIndicesIn)) {}
 };
 
 DECLARE_DYNAMIC_DELEGATE_OneParam(FDonNavigationDynamicCollisionDelegate, const FDonNavigationDynamicCollisionPayload&, Data); // note: non-dynamic delegate can't be used as a function parameter apparently
@@ -244,6 +358,26 @@ struct FDoNNavigationQueryParams
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DoN Navigation")
 	int32 MaxOptimizerSweepAttemptsPerNode = 25;
 
+	/** Search algorithm for this query. Lazy Theta* checks grid line of sight during the search instead of straightening the path afterwards (see bOptimizeAnyAnglePath).
+	*   Anytime planning is not available with Lazy Theta*.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DoN Navigation")
+	EDonNavigationSolverMode SolverMode = EDonNavigationSolverMode::AStar;
+
+	/** Lazy Theta* paths already only turn where the voxel grid requires it, so the sweep based optimization pass is skipped for them unless this is set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DoN Navigation")
+	bool bOptimizeAnyAnglePath = false;
+
+	/** Fits a collision checked spline through the final path on the navigation worker (see FDonNavigationPathResult::Spline).
+	*   Fly To follows the spline when available, which removes the stutter at path corners.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DoN Navigation")
+	bool bBuildPathSpline = false;
+
+	/** Number of samples per path segment for the path spline. Each sample is collision checked, so higher values are smoother and costlier */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DoN Navigation", meta = (EditCondition = "bBuildPathSpline", ClampMin = 1, ClampMax = 64))
+	int32 PathSplineSamplesPerSegment = 8;
+
 	/** Enabling this will sample all voxels of your pawn or character for determining whether a path solution
 	*  needs to be recalculated due to dynamic obstacles. This will improve the accuracy of response to dynamic collisions
 	*  but comes at a steep cost as the number of event delegates required for listening to precise dynamic collisions is high
@@ -272,6 +406,57 @@ struct FDoNNavigationQueryParams
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DoN Navigation")
 	bool bForceRescheduleQuery = false;	
 
+	/** Solves this query with a goal-rooted search and keeps that search alive after the query completes, so that a later repair
+	*   (see ADonNavigationManager::RepairPathfindingTask) only re-solves the part invalidated by dynamic obstacles instead of starting over.
+	*   Bound worlds only. Costs memory per owner for as long as the search is retained.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DoN Navigation")
+	bool bRetainSearchForRepair = false;
+
+	/** Anytime planning: a first path is found quickly with an inflated heuristic and published straight away (with bIsFinalResult = false),
+	*   then refined towards the optimal path while the query's budget remains, publishing each improvement. If the query times out,
+	*   the best path found so far is returned as the final result instead of failing. Bound worlds only.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DoN Navigation")
+	bool bAnytimePlanning = false;
+
+	/** Heuristic inflation for the first anytime path. Higher values find a (longer) first path faster */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1), Category = "DoN Navigation")
+	float AnytimeInitialHeuristicWeight = 3.f;
+
+	/** How much the heuristic inflation is reduced after each published path, until it reaches 1 (optimal) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0.01), Category = "DoN Navigation")
+	float AnytimeWeightDecrement = 0.5f;
+
+	/** If the query times out or has no solution, return the path to the explored location nearest to the destination with the status "PartialSuccess"
+	*   instead of failing, so the agent can make progress and query again from closer.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DoN Navigation")
+	bool bAllowPartialPath = false;
+
+	/** Restricts the search to an ellipsoid around the origin-destination segment, so a blocked direct line doesn't send the solver exploring
+	*   the far corners of the world. If no path exists inside the corridor it is widened to each of SearchCorridorScales in turn, then lifted.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DoN Navigation")
+	bool bUseSearchCorridor = false;
+
+	/** Corridor sizes to try, as multiples of the origin-destination distance (the summed distance of a point to both ends may not exceed this) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DoN Navigation")
+	TArray<float> SearchCorridorScales = { 1.5f, 3.f };
+
+	/** Extra room around the corridor, in voxels. Keeps short queries from getting an unusably thin corridor */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0), Category = "DoN Navigation")
+	int32 SearchCorridorPaddingVoxels = 2;
+
+	/** Scheduling class of this query, eg: player-visible bosses above ambient wildlife */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DoN Navigation")
+	EDonNavigationQueryPriority Priority = EDonNavigationQueryPriority::Normal;
+
+	/** Optional deadline, in seconds from scheduling. A query's scheduling weight grows as its deadline approaches (see ADonNavigationManager::DeadlineUrgencyBoost)
+	*   and falls back to normal once the deadline has passed. 0 = no deadline */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0), Category = "DoN Navigation")
+	float Deadline = 0.f;
+
 	/** Generic pointer allowing you to store anything you like to be passed back as payload.
 	*   Typically used for passing unqiue identifiers in situations where you can't otherwise identify the task owner
 	*   (Eg: Behavior tree singleton nodes)
@@ -345,6 +530,36 @@ struct FDonNavigationLocVector : public FVector
 	friend uint32 GetTypeHash(const FDonNavigationLocVector& Key) { return FCrc::MemCrc32(&Key, sizeof(Key)); } // similar to FVector's hash, although that uses FCrc::MemCrc_DEPRECATED instead
 };
 
+/**
+* Compact, immutable result of a navigation query. It is reference counted and shared between the query data handed to the result delegate and
+* whoever keeps following the path, so holding on to a path for the length of a flight costs a pointer instead of a copy of the whole query.
+*/
+struct FDonNavigationPathResult
+{
+	EDonNavigationQueryStatus Status = EDonNavigationQueryStatus::Unscheduled;
+	bool bIsFinalResult = true;
+
+	/** Path to follow (the optimized solution) */
+	TArray<FVector> Path;
+
+	/** Every voxel crossed by the path, in order, so there are usually several per segment of Path (see PathPointVolumeIndices). Needed to stop listening to dynamic collisions along it (Finite Worlds only) */
+	TArray<FDonNavigationVoxel*> PathVolumes;
+
+	/** Index into PathVolumes at which each point of Path begins (filled for paths with a dynamic collision subscription) */
+	TArray<int32> PathPointVolumeIndices;
+
+	bool bPreciseDynamicCollisionRepathing = false;
+	FDonVoxelCollisionProfile VoxelCollisionProfile;
+
+	/** Dynamic collision subscription of the path (see ADonNavigationManager::StopListeningToDynamicCollisionsForPathResult) */
+	int32 DynamicCollisionSubscriptionId = INDEX_NONE;
+
+	/** Smoothed path, for final results of queries with bBuildPathSpline set. Its points are those of Path */
+	TSharedPtr<const FDonNavigationPathSpline, ESPMode::ThreadSafe> Spline;
+};
+
+typedef TSharedPtr<const FDonNavigationPathResult, ESPMode::ThreadSafe> FDonNavigationPathResultPtr;
+
 /** 
 * Encapsulates all the data relevant for a single navigation query request. 
   Some variables in this are updated in real-time per tick as the navigation solver sequentially processes each task in its queue
@@ -378,12 +593,24 @@ struct FDoNNavigationQueryData
 
 	FDonVoxelCollisionProfile VoxelCollisionProfile;
 
+	/** Agent size class layer picked for this query at schedule time, if any. When set, the solver tests single voxels of that layer instead of the collision profile */
+	int32 AgentSizeLayer = INDEX_NONE;
+
 	// Processing state variables	
 	bool bGoalFound = false;
 	bool bGoalOptimized = false;	
+	bool bServedFromPathCache = false;
+
+	/** Shared reverse search this query was coalesced into, if any (see ADonNavigationManager::bCoalesceSharedDestinationQueries) */
+	int32 CoalescedSearchId = INDEX_NONE;
+	bool bSolutionFromCoalescedSearch = false;
+
 	FDonNavigationVoxel* OriginVolume;
 	FDonNavigationVoxel* DestinationVolume;	
 
+	/** Subscription through which the query's dynamic collision listener watches the final path, if any (Finite Worlds only) */
+	int32 DynamicCollisionSubscriptionId = INDEX_NONE;
+
 	DoNNavigation::PriorityQueue<FDonNavigationVoxel*> Frontier;	
 	TMap<FDonNavigationVoxel*, uint32> VolumeVsCostMap;
 	TMap<FDonNavigationVoxel*, FDonNavigationVoxel*> VolumeVsGoalTrajectoryMap;
@@ -399,20 +626,81 @@ struct FDoNNavigationQueryData
 
 	// Iteration Stats	
 	int32 SolverIterationCount = 0;
-	float SolverTimeTaken = 0.f;
+	float SolverTimeTaken = 0.f; // wall-clock seconds since the solver first picked up the query, checked against QueryParams.QueryTimeout
+
+	/** Seconds from scheduling until the solver first picked up the query */
+	UPROPERTY(BlueprintReadOnly, Category = "DoN Navigation")
+	float QueueWaitTime = 0.f;
+
+	/** Seconds spent searching for a path (excluding time spent waiting for other queries) */
+	UPROPERTY(BlueprintReadOnly, Category = "DoN Navigation")
+	float SolveTime = 0.f;
+
+	/** Seconds spent optimizing the path found */
+	UPROPERTY(BlueprintReadOnly, Category = "DoN Navigation")
+	float OptimizeTime = 0.f;
 
 	// Solution			
 	TArray<FDonNavigationVoxel*> VolumeSolution;
 	TArray<FDonNavigationVoxel*> VolumeSolutionOptimized;
 
+	/** Index into VolumeSolutionOptimized at which each point of PathSolutionOptimized begins (see ADonNavigationManager::SubscribeToDynamicCollisions) */
+	TArray<int32> PathPointVolumeIndices;
+
 	UPROPERTY(BlueprintReadOnly, Category = "DoN Navigation")
 	TArray<FVector> PathSolutionRaw;	
 
 	UPROPERTY(BlueprintReadOnly, Category = "DoN Navigation")
 	TArray<FVector> PathSolutionOptimized;
 
+	/** Spline through PathSolutionOptimized, built on completion if QueryParams.bBuildPathSpline is set */
+	TSharedPtr<const FDonNavigationPathSpline, ESPMode::ThreadSafe> PathSpline;
+
 	UPROPERTY(BlueprintReadOnly, Category = "DoN Navigation")
 	EDonNavigationQueryStatus QueryStatus = EDonNavigationQueryStatus::Unscheduled;
+
+	/** False for the provisional paths published by anytime queries (see FDoNNavigationQueryParams::bAnytimePlanning): a better path will follow */
+	UPROPERTY(BlueprintReadOnly, Category = "DoN Navigation")
+	bool bIsFinalResult = true;
+
+	// Anytime planning state
+	float HeuristicWeight = 1.f;
+	bool bHasAnytimeSolution = false;
+	TSet<FDonNavigationVoxel*> AnytimeClosedVolumes;
+	TSet<FDonNavigationVoxel*> AnytimeInconsistentVolumes;
+
+	// Lazy Theta* state
+	TSet<FDonNavigationVoxel*> LazyThetaClosedVolumes;
+
+	FORCEINLINE bool UsesLazyThetaStar() const { return QueryParams.SolverMode == EDonNavigationSolverMode::LazyThetaStar && !bSolutionFromCoalescedSearch; }
+
+	// Search corridor state (see FDoNNavigationQueryParams::bUseSearchCorridor)
+	FVector SearchCorridorFocusA = FVector::ZeroVector;
+	FVector SearchCorridorFocusB = FVector::ZeroVector;
+	float SearchCorridorMaxDistSum = 0.f; // unbounded if <= 0
+
+	/** Explored volumes with a neighbor cut off by the current corridor: the only ones a wider corridor needs to expand again (see ADonNavigationManager::WidenSearchCorridor) */
+	TSet<FDonNavigationVoxel*> SearchCorridorBoundary;
+	TSet<FDonNavigationLocVector> SearchCorridorBoundary_Unbound;
+
+	/** Nodes expanded by each search corridor attempt, tightest corridor first. Empty if the query did not use a corridor */
+	UPROPERTY(BlueprintReadOnly, Category = "DoN Navigation")
+	TArray<int32> SearchCorridorExpansions;
+
+	FORCEINLINE bool IsOutsideSearchCorridor(const FVector& Location) const
+	{
+		return SearchCorridorMaxDistSum > 0.f && FVector::Dist(Location, SearchCorridorFocusA) + FVector::Dist(Location, SearchCorridorFocusB) > SearchCorridorMaxDistSum;
+	}
+
+	// Solver cost per iteration, exponential moving average (see ADonNavigationManager::bUsePathSolverTimeBudget)
+	double SecondsPerIteration = 0.0;
+
+	// Scheduling (FPlatformTime::Seconds)
+	double TimeScheduled = 0.0;
+	double TimeFirstServiced = 0.0;
+
+	FORCEINLINE bool HasDeadline() const { return QueryParams.Deadline > 0.f; }
+	FORCEINLINE double AbsoluteDeadline() const { return TimeScheduled + QueryParams.Deadline; }
 	
 	
 	FDoNNavigationQueryData(){}
@@ -446,6 +734,45 @@ struct FDoNNavigationQueryData
 		return PathSolutionRaw.Num() - optimizer_j > QueryParams.MaxOptimizerSweepAttemptsPerNode;
 	}
 
+	/** Shared result of this query, built when the query completes. Keep this rather than a copy of the query data to follow the path */
+	FDonNavigationPathResultPtr Result;
+
+	void BuildResult()
+	{
+		auto result = MakeShared<FDonNavigationPathResult, ESPMode::ThreadSafe>();
+		result->Status = QueryStatus;
+		result->bIsFinalResult = bIsFinalResult;
+		result->Path = PathSolutionOptimized;
+		result->PathVolumes = VolumeSolutionOptimized;
+		result->PathPointVolumeIndices = PathPointVolumeIndices;
+		result->bPreciseDynamicCollisionRepathing = QueryParams.bPreciseDynamicCollisionRepathing;
+		result->VoxelCollisionProfile = VoxelCollisionProfile;
+		result->DynamicCollisionSubscriptionId = DynamicCollisionSubscriptionId;
+		result->Spline = PathSpline;
+
+		Result = result;
+	}
+
+	/** Frees the search state (frontier, cost and trajectory maps, etc) as soon as the query is done with it */
+	void ReleaseSolverState()
+	{
+		Frontier = DoNNavigation::PriorityQueue<FDonNavigationVoxel*>();
+		VolumeVsCostMap.Empty();
+		VolumeVsGoalTrajectoryMap.Empty();
+
+		Frontier_Unbound = DoNNavigation::PriorityQueue<FDonNavigationLocVector>();
+		VolumeVsCostMap_Unbound.Empty();
+		VolumeVsGoalTrajectoryMap_Unbound.Empty();
+
+		AnytimeClosedVolumes.Empty();
+		AnytimeInconsistentVolumes.Empty();
+		LazyThetaClosedVolumes.Empty();
+
+		SearchCorridorBoundary.Empty();
+		SearchCorridorBoundary_Unbound.Empty();
+
+		VolumeSolution.Empty();
+	}
 };
 
 /** 
@@ -458,6 +785,7 @@ enum class EDonNavigationRequestType : uint8
 {
 	New,
 	Abort,
+	ReleaseRetainedSearch,
 };
 
 USTRUCT()
@@ -507,9 +835,42 @@ struct FDonNavigationQueryTask : public FDonNavigationTask
 		}
 
 		Data.QueryStatus = EDonNavigationQueryStatus::InProgress;
+		Data.HeuristicWeight = InData.QueryParams.bAnytimePlanning && InData.QueryParams.SolverMode == EDonNavigationSolverMode::AStar ? FMath::Max(InData.QueryParams.AnytimeInitialHeuristicWeight, 1.f) : 1.f;
+		Data.TimeScheduled = FPlatformTime::Seconds();
 		RequestType = EDonNavigationRequestType::New;
 	}
 
+	/** Copy of this task carrying the query inputs and current solution but none of the solver state, for publishing results while the query continues */
+	FDonNavigationQueryTask CopyForResult() const
+	{
+		FDonNavigationQueryTask result;
+		result.ResultHandler = ResultHandler;
+		result.DynamicCollisionListener = DynamicCollisionListener;
+
+		result.Data.Actor = Data.Actor;
+		result.Data.CollisionComponent = Data.CollisionComponent;
+		result.Data.Origin = Data.Origin;
+		result.Data.Destination = Data.Destination;
+		result.Data.QueryParams = Data.QueryParams;
+		result.Data.DebugParams = Data.DebugParams;
+		result.Data.OriginVolume = Data.OriginVolume;
+		result.Data.DestinationVolume = Data.DestinationVolume;
+		result.Data.SolverIterationCount = Data.SolverIterationCount;
+		result.Data.SolverTimeTaken = Data.SolverTimeTaken;
+		result.Data.QueueWaitTime = Data.QueueWaitTime;
+		result.Data.SolveTime = Data.SolveTime;
+		result.Data.OptimizeTime = Data.OptimizeTime;
+		result.Data.VolumeSolution = Data.VolumeSolution;
+		result.Data.VolumeSolutionOptimized = Data.VolumeSolutionOptimized;
+		result.Data.PathSolutionRaw = Data.PathSolutionRaw;
+		result.Data.PathSolutionOptimized = Data.PathSolutionOptimized;
+		result.Data.QueryStatus = Data.QueryStatus;
+		result.Data.bIsFinalResult = Data.bIsFinalResult;
+		result.Data.SearchCorridorExpansions = Data.SearchCorridorExpansions;
+
+		return result;
+	}
+
 	FORCEINLINE bool IsQueryComplete()
 	{
 		return Data.QueryStatus != EDonNavigationQueryStatus::InProgress;
@@ -517,10 +878,30 @@ struct FDonNavigationQueryTask : public FDonNavigationTask
 
 	virtual void BroadcastResult() override
 	{
+		if (!Data.Result.IsValid())
+			Data.BuildResult();
+
 		ResultHandler.ExecuteIfBound(Data);
 	}	
 };
 
+/**
+* Slab of navigation tasks shared by the game and worker threads. Requests and results travel between the threads as pointers into the pool,
+* so a query is never copied through the task queues. Tasks are acquired and released from either thread without locking (the slab only grows under lock).
+*/
+class FDonNavigationQueryTaskPool
+{
+public:
+	FDonNavigationQueryTask* Acquire();
+	void Release(FDonNavigationQueryTask* Task);
+
+private:
+	TLockFreePointerListUnordered<FDonNavigationQueryTask, PLATFORM_CACHE_LINE_SIZE> FreeTasks;
+
+	TArray<TUniquePtr<FDonNavigationQueryTask>> Slab;
+	FCriticalSection SlabLock;
+};
+
 DECLARE_DYNAMIC_DELEGATE_OneParam(FDonCollisionSamplerCallback, bool, bTaskSuccessful);
 
 struct FDonMeshIdentifier
@@ -604,6 +985,7 @@ struct FDonNavigationDynamicCollisionTask : public FDonNavigationTask
 	// Internal processing:
 	int32 i, j, k;
 	int xLength, yLength, zLength;	
+	FDonVoxelOffsetList SampledOccupancy;
 	bool bCollisionProfileSamplingComplete = false;
 	bool bCollisionFetchSuccess = false;
 	bool bCollisionOccupancyUpdatesComplete = false;
@@ -651,6 +1033,254 @@ struct FDonNavigationDynamicCollisionTask : public FDonNavigationTask
 	}	
 };
 
+/** Key of the result path cache: a path is reused by any query between the same pair of voxels for the same agent size class and collision shape.
+*   The shape matters because the optimized path was validated by sweeps of it (inflated by the query's CollisionShapeInflation); its extent is rounded up to whole units.
+*/
+struct FDonPathCacheKey
+{
+	FDonNavigationVoxel* OriginVolume = NULL;
+	FDonNavigationVoxel* DestinationVolume = NULL;
+	int32 SizeClass = 0;
+	int32 ShapeType = 0;
+	FIntVector ShapeExtent = FIntVector::ZeroValue;
+	float CollisionShapeInflation = 0.f;
+
+	friend bool operator== (const FDonPathCacheKey& A, const FDonPathCacheKey& B)
+	{
+		return A.OriginVolume == B.OriginVolume && A.DestinationVolume == B.DestinationVolume && A.SizeClass == B.SizeClass
+			&& A.ShapeType == B.ShapeType && A.ShapeExtent == B.ShapeExtent && A.CollisionShapeInflation == B.CollisionShapeInflation;
+	}
+
+	friend uint32 GetTypeHash(const FDonPathCacheKey& Key)
+	{
+		uint32 hash = HashCombine(HashCombine(GetTypeHash(Key.OriginVolume), GetTypeHash(Key.DestinationVolume)), GetTypeHash(Key.SizeClass));
+		hash = HashCombine(hash, GetTypeHash(Key.ShapeType));
+		hash = HashCombine(hash, GetTypeHash(Key.ShapeExtent));
+
+		return HashCombine(hash, GetTypeHash(Key.CollisionShapeInflation));
+	}
+};
+
+struct FDonPathCacheEntry
+{
+	TArray<FDonNavigationVoxel*> VolumeSolution;
+	TArray<FDonNavigationVoxel*> VolumeSolutionOptimized;
+	TArray<FVector> PathSolutionRaw;
+	TArray<FVector> PathSolutionOptimized;
+
+	/** Every voxel whose occupation by a dynamic obstacle invalidates this entry (the path and, for large pawns, the space around it) */
+	TArray<FDonNavigationVoxel*> WatchedVolumes;
+
+	double TimeAdded = 0.0;
+	double TimeLastUsed = 0.0;
+};
+
+/** A path's dynamic collision listener, registered in bulk when the path is packaged (see ADonNavigationManager::SubscribeToDynamicCollisions) */
+struct FDonCollisionSubscription
+{
+	FDonNavigationDynamicCollisionDelegate Listener;
+	void* CustomDelegatePayload = NULL;
+
+	/** Sorted compact ids (see ADonNavigationManager::VoxelIdFor) of every voxel watched, including the space around the path for bPreciseDynamicCollisionRepathing */
+	TArray<int32> VoxelIds;
+
+	/** The path itself, to tell listeners which of its indices an obstacle landed on */
+	TArray<FDonNavigationVoxel*> PathVolumes;
+
+	/** Index into PathVolumes at which each point of the path begins. Progress is reported in path points, see ProgressIndex */
+	TArray<int32> PathPointVolumeIndices;
+	FDonVoxelCollisionProfile VoxelCollisionProfile;
+	bool bPreciseDynamicCollisionRepathing = false;
+
+	/** First index of PathVolumes still ahead of the listener (see ADonNavigationManager::SetDynamicCollisionPathProgress). Obstacles on the path before it are not reported */
+	int32 ProgressIndex = 0;
+
+	/** Appends the path indices ahead of the progress cursor watching the given voxel, either directly or through the space around the path */
+	void AppendPathIndicesWatching(const FDonNavigationVoxel* Volume, TArray<int32>& Indices) const
+	{
+		const FDonVoxelOffset& boundsMin = VoxelCollisionProfile.OffsetsMin;
+		const FDonVoxelOffset& boundsMax = VoxelCollisionProfile.OffsetsMax;
+
+		for (int32 i = FMath::Max(ProgressIndex, 0); i < PathVolumes.Num(); i++)
+		{
+			const FDonNavigationVoxel* pathVolume = PathVolumes[i];
+			if (!pathVolume)
+				continue;
+
+			if (pathVolume == Volume)
+			{
+				Indices.Add(i);
+				continue;
+			}
+
+			if (!bPreciseDynamicCollisionRepathing)
+				continue;
+
+			const int32 dx = Volume->X - pathVolume->X;
+			const int32 dy = Volume->Y - pathVolume->Y;
+			const int32 dz = Volume->Z - pathVolume->Z;
+
+			if (dx < boundsMin.X || dx > boundsMax.X || dy < boundsMin.Y || dy > boundsMax.Y || dz < boundsMin.Z || dz > boundsMax.Z)
+				continue;
+
+			for (const FDonVoxelOffset& offset : VoxelCollisionProfile.Offsets())
+			{
+				if (offset.X == dx && offset.Y == dy && offset.Z == dz)
+				{
+					Indices.Add(i);
+					break;
+				}
+			}
+		}
+	}
+};
+
+/** Subscriptions watching a single voxel. Most voxels are only watched by a path or two at a time */
+typedef TArray<int32, TInlineAllocator<2>> FDonCollisionSubscriberList;
+
+/**
+* A single reverse search rooted at a goal voxel, shared by every query flying to that goal with the same agent size.
+* The search expands outwards from the goal in order of cost (a flow field), so each member's path is read straight off the parent map once its origin is settled.
+*/
+struct FDonCoalescedSearch
+{
+	FDonNavigationVoxel* GoalVolume = NULL;
+
+	// Navigability is tested against the agent that founded the search; members are only admitted if they share its size
+	FDonVoxelCollisionProfile VoxelCollisionProfile;
+	int32 AgentSizeLayer = INDEX_NONE;
+
+	DoNNavigation::PriorityQueue<FDonNavigationVoxel*> Frontier;
+	TMap<FDonNavigationVoxel*, uint32> VolumeVsCostMap;
+	TMap<FDonNavigationVoxel*, FDonNavigationVoxel*> VolumeVsParentMap; // parent = next step towards the goal
+	TSet<FDonNavigationVoxel*> SettledVolumes;
+	TSet<FDonNavigationVoxel*> MemberOrigins;
+
+	int32 NumMembers = 0;
+
+	/** If set, the search is goal-directed (A*) towards this volume instead of expanding uniformly */
+	FDonNavigationVoxel* HeuristicTarget = NULL;
+
+	// Retained searches (see FDoNNavigationQueryParams::bRetainSearchForRepair) outlive their queries and are repaired in place:
+	AActor* RetainedBy = NULL;
+	double TimeLastUsed = 0.0;
+	TSet<FDonNavigationVoxel*> PendingBlockedVolumes;
+};
+
+/** Box of voxels covered by a flow field, in voxel coordinates of the owning manager. Cells are laid out densely, X-major */
+struct FDonFlowFieldRegion
+{
+	int32 MinX = 0, MinY = 0, MinZ = 0;
+	int32 SizeX = 0, SizeY = 0, SizeZ = 0;
+
+	FORCEINLINE int32 NumCells() const { return SizeX * SizeY * SizeZ; }
+
+	FORCEINLINE bool ContainsVoxel(int32 X, int32 Y, int32 Z) const
+	{
+		return X >= MinX && Y >= MinY && Z >= MinZ && X < MinX + SizeX && Y < MinY + SizeY && Z < MinZ + SizeZ;
+	}
+
+	FORCEINLINE int32 CellIndex(int32 X, int32 Y, int32 Z) const { return ((X - MinX) * SizeY + (Y - MinY)) * SizeZ + (Z - MinZ); }
+
+	FORCEINLINE void VoxelAtCell(int32 Cell, int32& X, int32& Y, int32& Z) const
+	{
+		Z = MinZ + Cell % SizeZ;
+		Y = MinY + (Cell / SizeZ) % SizeY;
+		X = MinX + Cell / (SizeZ * SizeY);
+	}
+
+	FORCEINLINE bool Intersects(int32 BoxMinX, int32 BoxMinY, int32 BoxMinZ, int32 BoxMaxX, int32 BoxMaxY, int32 BoxMaxZ) const
+	{
+		return BoxMaxX >= MinX && BoxMinX < MinX + SizeX && BoxMaxY >= MinY && BoxMinY < MinY + SizeY && BoxMaxZ >= MinZ && BoxMinZ < MinZ + SizeZ;
+	}
+};
+
+/**
+* Immutable, published result of a flow field build: one direction per voxel of a bounded region, pointing at the next voxel towards the goal.
+* Snapshots are shared with callers by pointer and never modified afterwards, so sampling needs no locks and is a single array lookup.
+*/
+struct FDonFlowFieldSnapshot : public FDonFlowFieldRegion
+{
+	int32 FlowFieldId = INDEX_NONE;
+	int32 Version = 0;
+
+	// Grid placement, copied from the manager so the snapshot can be sampled on its own
+	FVector GridOrigin = FVector::ZeroVector;
+	float VoxelSize = 0.f;
+
+	FVector GoalLocation = FVector::ZeroVector;
+
+	/** Per voxel: a packed neighbor offset (see PackDirection) or one of the special values below */
+	TArray<uint8> Directions;
+
+	static const uint8 Unreachable = 0xFF;
+	static const uint8 AtGoal = 0xFE;
+
+	FORCEINLINE static uint8 PackDirection(int32 DX, int32 DY, int32 DZ) { return (DX + 1) * 9 + (DY + 1) * 3 + (DZ + 1); }
+	FORCEINLINE static FVector UnpackDirection(uint8 Packed) { return FVector(Packed / 9 - 1, (Packed / 3) % 3 - 1, Packed % 3 - 1).GetSafeNormal(); }
+
+	/** Unit direction to fly in from Location. Returns false outside the region or where the goal is unreachable */
+	bool Sample(const FVector& Location, FVector& OutDirection) const
+	{
+		const int32 x = FMath::FloorToInt((Location.X - GridOrigin.X) / VoxelSize);
+		const int32 y = FMath::FloorToInt((Location.Y - GridOrigin.Y) / VoxelSize);
+		const int32 z = FMath::FloorToInt((Location.Z - GridOrigin.Z) / VoxelSize);
+
+		if (!ContainsVoxel(x, y, z))
+			return false;
+
+		const uint8 direction = Directions[CellIndex(x, y, z)];
+
+		if (direction == Unreachable)
+			return false;
+
+		OutDirection = direction == AtGoal ? (GoalLocation - Location).GetSafeNormal() : UnpackDirection(direction);
+
+		return true;
+	}
+};
+
+enum class EDonFlowFieldRequestType : uint8
+{
+	Build,
+	Release,
+};
+
+/** A flow field owned by the solver thread: its build state and the parameters needed to rebuild it when dynamic collision changes its region */
+struct FDonFlowFieldTask : public FDonFlowFieldRegion
+{
+	int32 FlowFieldId = INDEX_NONE;
+	EDonFlowFieldRequestType RequestType = EDonFlowFieldRequestType::Build;
+
+	FDonNavigationVoxel* GoalVolume = NULL;
+	FVector GoalLocation = FVector::ZeroVector;
+
+	FDonVoxelCollisionProfile VoxelCollisionProfile;
+	int32 AgentSizeLayer = INDEX_NONE;
+
+	// Build state
+	bool bBuildInProgress = false;
+	bool bDirty = true;
+	int32 Version = 0;
+
+	DoNNavigation::PriorityQueue<int32> Frontier;
+	TArray<uint32> Costs;
+	TBitArray<> Settled;
+	TArray<uint8> Directions;
+};
+
+/** Voxel bounds touched by a dynamic collision update. Queued from whichever thread ran the update and applied to the flow fields on the solver thread */
+struct FDonFlowFieldDirtyRegion
+{
+	FIntVector Min;
+	FIntVector Max;
+
+	FDonFlowFieldDirtyRegion() {}
+	FDonFlowFieldDirtyRegion(const FIntVector& Min, const FIntVector& Max) : Min(Min), Max(Max) {}
+};
+
+typedef TSharedPtr<const FDonFlowFieldSnapshot, ESPMode::ThreadSafe> FDonFlowFieldSnapshotPtr;
+
 struct FCollisionShape;
 class USceneComponent;
 class UBillboardComponent;
@@ -785,6 +1415,107 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Performance Settings | Infinite Worlds | Multithreaded")
 	int32 MaxCollisionSolverIterationsOnThread_Unbound = 500;
 
+	/** Budget the path solver by wall-clock time instead of iteration counts. The cost of an iteration is measured per query and the
+	*   iteration quanta adapt to it, so the frame time spent on pathfinding stays predictable however expensive iterations get
+	*   (an Infinite World iteration can cost dozens of physics overlaps, a Finite World one a few nanoseconds).
+	*   The iteration counts above still apply to collision sampling and until a query's first cost measurement.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Performance Settings | Time Budget")
+	bool bUsePathSolverTimeBudget = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1), Category = "Performance Settings | Time Budget")
+	float PathSolverTimeBudgetPerTickMicroseconds = 1000.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1), Category = "Performance Settings | Time Budget")
+	float PathSolverTimeBudgetOnThreadMicroseconds = 4000.f;
+
+	/** Bound worlds only. Pawns larger than a voxel are tested against a per-voxel clearance field (distance to the nearest obstacle) with a single lookup
+	*   instead of testing every voxel of their collision profile. The test treats the pawn as a cube of its largest profile extent, so oddly shaped pawns
+	*   may be kept out of gaps their exact profile would fit through. Pawns wider than MaxClearanceVoxels fall back to full profile testing.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Performance Settings | Clearance")
+	bool bUseClearanceField = false;
+
+	/** Largest clearance (in voxels) tracked by the clearance field. Higher values cover larger pawns but make each lazy clearance evaluation and each dynamic collision update more expensive. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1, ClampMax = 32), Category = "Performance Settings | Clearance")
+	int32 MaxClearanceVoxels = 4;
+
+	/** Bound worlds only. Agent size classes (radius in voxels, up to 8 classes) for which the manager maintains a derived occupancy layer: the base occupancy
+	*   dilated by that radius. At schedule time every query larger than a voxel is assigned the smallest class that covers its collision profile,
+	*   after which the solver only needs a single voxel lookup per node. Queries larger than every class fall back to full profile testing.
+	*   Eg: 1, 2, 4
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Performance Settings | Agent Size Layers")
+	TArray<int32> AgentSizeClasses;
+
+	/** Bound worlds only. Reuses solved paths for queries between the same origin voxel and destination voxel by pawns of the same size class, skipping the solver entirely.
+	*   A cached path is dropped as soon as a dynamic obstacle occupies any voxel along it. Useful for swarms patrolling between the same few regions.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Performance Settings | Path Cache")
+	bool bEnablePathCache = false;
+
+	/** Maximum number of cached paths. The least recently used path is evicted to make room for new ones */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1), Category = "Performance Settings | Path Cache")
+	int32 PathCacheCapacity = 128;
+
+	/** Cached paths older than this (in seconds) are discarded instead of being reused. Set to zero to keep paths until they're invalidated or evicted */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0), Category = "Performance Settings | Path Cache")
+	float PathCacheTimeToLive = 10.f;
+
+	/** When several queries fly to the same destination (e.g. a flock sharing a blackboard target) they are solved by one reverse search from the goal instead of N independent searches. Bound worlds only */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Performance Settings | Query Coalescing")
+	bool bCoalesceSharedDestinationQueries = false;
+
+	/** Queries whose destination voxels lie within this many voxels of each other (and have a clear line to the shared goal) are coalesced */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0), Category = "Performance Settings | Query Coalescing")
+	int32 CoalescingDestinationToleranceVoxels = 0;
+
+	/** Minimum number of new queries sharing a destination before a shared search is started. A lone query is always better served by the regular (goal-directed) solver */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 2), Category = "Performance Settings | Query Coalescing")
+	int32 MinQueriesToCoalesce = 2;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1), Category = "Performance Settings | Flow Fields")
+	int32 MaxFlowFieldIterationsPerTick = 1000;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1), Category = "Performance Settings | Flow Fields")
+	int32 MaxFlowFieldIterationsOnThread = 4000;
+
+	/** Upper bound on the number of voxels a single flow field may cover (one byte each once built, plus 4 bytes each while building). Larger regions are shrunk around the goal */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1), Category = "Performance Settings | Flow Fields")
+	int32 MaxFlowFieldVoxels = 262144;
+
+	/** Upper bound on the number of searches kept alive for path repair (see FDoNNavigationQueryParams::bRetainSearchForRepair). The least recently used one is dropped first */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1), Category = "Performance Settings | Path Repair")
+	int32 MaxRetainedSearches = 16;
+
+	/** Seconds a query must wait to gain another full weight of its own priority class. Keeps low priority queries from starving behind a steady stream of high priority ones. 0 disables aging */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0), Category = "Performance Settings | Scheduling")
+	float PriorityAgingTime = 1.f;
+
+	/** Extra scheduling weight, in multiples of its own, a query with a deadline gains as the deadline approaches (reached just before it is due).
+	*   Bounded, so aging still lets queries without a deadline overtake a steady stream of deadline queries. Past due queries lose the boost */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0), Category = "Performance Settings | Scheduling")
+	float DeadlineUrgencyBoost = 8.f;
+
+	/** Bound worlds only. The path optimizer walks the voxel grid along each shortcut it considers and only confirms the ones not crossing an occupied voxel with physics sweeps.
+	*   The voxels holding the shortcut's own end points are not tested (an origin or goal may legitimately lie in an occupied voxel, eg: against a wall).
+	*   Off by default: a shortcut grazing an occupied voxel may still be clear for the pawn's actual collision shape, so the optimized paths can differ from the sweep-only ones.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Performance Settings | Path Optimizer")
+	bool bOptimizerGridLineOfSight = false;
+
+	/** Number of shortcut sweeps the path optimizer issues at once (in parallel). Each batch counts as a single optimizer iteration */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1, ClampMax = 64), Category = "Performance Settings | Path Optimizer")
+	int32 OptimizerSweepBatchSize = 8;
+
+	/** Bound worlds only. When an origin or destination lies in a blocked voxel, the nearest navigable voxel is searched for in rings around it, up to this many voxels out */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1, ClampMax = 16), Category = "Performance Settings | Location Resolution")
+	int32 NearestNavigableVolumeSearchRadius = 4;
+
+	/** Number of access sweeps issued at once (in parallel) while searching for the nearest navigable voxel */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 1, ClampMax = 64), Category = "Performance Settings | Location Resolution")
+	int32 NearestNavigableVolumeSweepBatchSize = 8;
+
 	void RefreshPerformanceSettings();
 
 	// World generation
@@ -833,6 +1564,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")	
 	void Debug_ClearAllVolumes();
 
+	/** 
+	* Tests NumSegments random segments across the world with IsSegmentClearInGrid and with a physics sweep of CollisionComponent (if given), then logs the time taken by each and how often they agree.
+	* Voxels are sampled on demand by the first run, run it twice to time a warm grid.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	void Debug_BenchmarkGridLineOfSight(UPrimitiveComponent* CollisionComponent, int32 NumSegments = 1000, int32 AgentRadiusVoxels = 0);
+
 	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
 	void Debug_RecalculateWorldBounds()
 	{
@@ -887,8 +1625,11 @@ private:
 	
 	// Scheduled Tasks: 
 
+	// Navigation tasks live in this pool, only pointers to them are passed around (and across threads)
+	FDonNavigationQueryTaskPool QueryTaskPool;
+
 	//(owned by worker thread)
-	TArray<FDonNavigationQueryTask,	TInlineAllocator<25>>  ActiveNavigationTasks;	
+	TArray<FDonNavigationQueryTask*, TInlineAllocator<25>>  ActiveNavigationTasks;	
 	TArray<FDonNavigationDynamicCollisionTask, TInlineAllocator<25>> ActiveDynamicCollisionTasks;
 
 	//(owned by game thread)
@@ -903,12 +1644,12 @@ private:
 	// Shared between worker thread and game thread via TQueue:
 	//TQueue<FDonNavigationQueryTask>  NewNavigationTasks;
 	//TQueue<AActor*>  NewNavigationAborts;
-	TQueue<FDonNavigationQueryTask> NewNavigationTasks;
+	TQueue<FDonNavigationQueryTask*> NewNavigationTasks;
 	TQueue<FDonNavigationDynamicCollisionTask>  NewDynamicCollisionTasks;
 
-	TQueue<FDonNavigationQueryTask>			   CompletedNavigationTasks;
+	TQueue<FDonNavigationQueryTask*>			   CompletedNavigationTasks;
 	TQueue<FDonNavigationDynamicCollisionTask> CompletedCollisionTasks;
-	TQueue<FDonNavigationVoxel*> DynamicCollisionBroadcastQueue;
+	TQueue<FDonNavigationVoxel*, EQueueMode::Mpsc> DynamicCollisionBroadcastQueue; // fed by collision updates on either thread, broadcast in one batch per tick
 
 	void ReceiveAsyncNavigationTasks();
 	//void ReceiveAsyncAbortRequests(); // deprecated
@@ -1016,6 +1757,14 @@ public:
 		return VolumeAtSafe(x, y, z);
 	}
 
+	inline FDonNavigationVoxel* NeighborAt(FDonNavigationVoxel* Volume, const FDonVoxelOffset& NeighborOffset)
+	{
+		if (!Volume)
+			return NULL;
+
+		return VolumeAtSafe(Volume->X + NeighborOffset.X, Volume->Y + NeighborOffset.Y, Volume->Z + NeighborOffset.Z);
+	}
+
 	/** Clamps a vector within the navigation bounds, as defined by the grid configuration of the navigation object you've placed in the map,
 	 *   brought in by a margin of InnerMarginOffset when clamping downward to prevent rounding errors */
 	UFUNCTION(BlueprintPure, Category = "DoN Navigation")
@@ -1089,12 +1838,57 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
 	void AbortPathfindingTask(AActor* Actor);
 
+	/**
+	*  Re-plans the path of an Actor whose last query was scheduled with bRetainSearchForRepair, towards the same destination, from the Actor's current location.
+	*  Only the part of the retained search invalidated by dynamic obstacles since then is re-solved; the rest is reused as is. Call this instead of scheduling
+	*  a new query when a dynamic collision listener reports that the current path is blocked.
+	*
+	*  @return false if the Actor has no retained search (schedule a regular query instead) or the repair query could not be scheduled
+	*/
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	bool RepairPathfindingTask(AActor* Actor, UPARAM(ref) const FDoNNavigationQueryParams& QueryParams, UPARAM(ref) const FDoNNavigationDebugParams& DebugParams, FDoNNavigationResultHandler ResultHandlerDelegate, FDonNavigationDynamicCollisionDelegate DynamicCollisionListener);
+
+	/** Frees the search retained for an Actor's path repairs. Call this once the Actor has arrived or given up */
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	void ReleaseRetainedSearch(AActor* Actor);
+
+	UFUNCTION(BlueprintPure, Category = "DoN Navigation")
+	bool HasRetainedSearch(AActor* Actor) const { return RetainedSearchDestinations.Contains(Actor); }
+
 	/** Does this actor have an active pathfinding task already scheduled with the navigation manager? */
 	UFUNCTION(BlueprintPure, Category = "DoN Navigation")
 	bool HasTask(AActor* Actor) { 
 		return ActiveNavigationTaskOwners.Contains(Actor); 
 	}
 
+	/**
+	*  Schedules a goal-centric flow field over a cube of voxels around Goal. Intended for swarms flying to one shared goal: instead of a query per agent,
+	*  every agent samples its direction from the field each frame (see SampleFlowField). The field is built over several ticks (on the worker thread if
+	*  multi-threading is enabled) and rebuilt whenever a dynamic collision update touches its region; the previous field stays usable meanwhile.
+	*
+	*  @param  Goal                   Where the swarm is headed. Must lie within the navigable world
+	*  @param  RegionRadiusVoxels     Half-size of the region (in voxels). Shrunk if the region would exceed MaxFlowFieldVoxels
+	*  @param  AgentCollisionComponent Collision of a representative agent, used for large pawns. May be null (a unit voxel agent)
+	*  @return A flow field id to sample with, or INDEX_NONE on failure
+	*/
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	int32 ScheduleFlowField(FVector Goal, int32 RegionRadiusVoxels, UPrimitiveComponent* AgentCollisionComponent);
+
+	/** Frees a flow field. Snapshots already handed out remain valid for as long as their holders keep them */
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	void ReleaseFlowField(int32 FlowFieldId);
+
+	/** Has the flow field published its first build yet? */
+	UFUNCTION(BlueprintPure, Category = "DoN Navigation")
+	bool IsFlowFieldReady(int32 FlowFieldId) const { return PublishedFlowFields.Contains(FlowFieldId); }
+
+	/** Unit direction an agent at Location should fly in to reach the flow field's goal. Returns false if the field isn't ready, Location lies outside it or the goal is unreachable from there */
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	bool SampleFlowField(int32 FlowFieldId, FVector Location, FVector& Direction) const;
+
+	/** Latest published snapshot of a flow field (game thread). Hold on to it to sample many agents without any further lookups */
+	FDonFlowFieldSnapshotPtr GetFlowFieldSnapshot(int32 FlowFieldId) const;
+
 
 	/**
 	*  Schedule Dynamic Collision Update For Mesh
@@ -1150,11 +1944,29 @@ public:
 	void StopListeningToDynamicCollisionsForPath(FDonNavigationDynamicCollisionDelegate ListenerToClear, UPARAM(ref) const FDoNNavigationQueryData& QueryData);
 
 	/** 
-	* Similar to StopListeningToDynamicCollisionsForPath, but operates on a single index. If you're using the pathfinding API directly, use this to "clean up" behind your pawn as it passes dynamic collision geometry
-	* (For users using the "Fly To" behavior tree node you don't need to worry about this as all cleanup is taken care of for you)
+	* Similar to StopListeningToDynamicCollisionsForPath, but operates on a single index. To "clean up" behind a pawn as it flies along its path, prefer SetDynamicCollisionPathProgress
+	* which only moves a cursor instead of unregistering voxels.
 	*/	
 	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
 	void StopListeningToDynamicCollisionsForPathIndex(FDonNavigationDynamicCollisionDelegate ListenerToClear, UPARAM(ref) const FDoNNavigationQueryData& QueryData, const int32 VolumeIndex);
+
+	/** Same as StopListeningToDynamicCollisionsForPath, for a query's shared result (see FDoNNavigationQueryData::Result) */
+	void StopListeningToDynamicCollisionsForPathResult(FDonNavigationDynamicCollisionDelegate ListenerToClear, const FDonNavigationPathResultPtr& PathResult);
+
+	/** Stops listening to the voxels of a path result from point PathIndex up to the next point (ie: that point and the segment leaving it) */
+	void StopListeningToDynamicCollisionsForPathResultIndex(FDonNavigationDynamicCollisionDelegate ListenerToClear, const FDonNavigationPathResultPtr& PathResult, const int32 PathIndex);
+
+	/** 
+	* Tells the manager how far along its path a pawn has flown. Obstacles landing on the path before point PathIndex are no longer reported to the listener, so a pawn won't
+	* needlessly recalculate its solution when something intrudes on space it has already left behind. If you're using the pathfinding API directly, call this with the index of each point
+	* (of PathSolutionOptimized) as your pawn reaches it.
+	* (For users using the "Fly To" behavior tree node you don't need to worry about this as it is taken care of for you)
+	*/
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	void SetDynamicCollisionPathProgress(FDonNavigationDynamicCollisionDelegate Listener, UPARAM(ref) const FDoNNavigationQueryData& QueryData, const int32 PathIndex);
+
+	/** Same as SetDynamicCollisionPathProgress, for a query's shared result (see FDoNNavigationQueryData::Result) */
+	void SetDynamicCollisionPathResultProgress(FDonNavigationDynamicCollisionDelegate Listener, const FDonNavigationPathResultPtr& PathResult, const int32 PathIndex);
 	
 	void VoxelCacheClearByKey(const FDonMeshIdentifier &MeshId)
 	{
@@ -1178,6 +1990,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
 	bool FindPathSolution_StressTesting(AActor* Actor, FVector Destination, TArray<FVector> &PathSolutionRaw, TArray<FVector> &PathSolutionOptimized, UPARAM(ref) const FDoNNavigationQueryParams& QueryParams, UPARAM(ref) const FDoNNavigationDebugParams& DebugParams);	
 
+	/** 
+	*  Solves the same query synchronously with A* (followed by the optimizer) and with Lazy Theta*, then logs the total time to the final path, its length and its number of points for each.
+	*  Like FindPathSolution_StressTesting, this is for profiling sessions only.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	void Debug_CompareSolverModes(AActor* Actor, FVector Destination, UPARAM(ref) const FDoNNavigationQueryParams& QueryParams);
+
 	// Tracing utility
 
 	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
@@ -1215,6 +2034,27 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
 	void VisualizeDynamicCollisionListeners(FDonNavigationDynamicCollisionDelegate Listener, UPARAM(ref) const FDoNNavigationQueryData& QueryData);
 
+	// Path cache:
+
+	/** Fraction of scheduled queries (that reached the solver) answered from the path cache */
+	UFUNCTION(BlueprintPure, Category = "DoN Navigation")
+	float GetPathCacheHitRate() const;
+
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	void GetPathCacheStats(int32& Hits, int32& Misses, int32& Invalidations, int32& NumEntries);
+
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	void ClearPathCache();
+
+	// Scheduling:
+
+	/** Queue time is measured from scheduling to the first solver tick, time to complete from scheduling to the result. Times are in seconds */
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	void GetQueueTimeStats(EDonNavigationQueryPriority PriorityClass, int32& NumQueries, float& AverageQueueTime, float& MaxQueueTime, float& AverageTimeToComplete, int32& DeadlinesMissed);
+
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	void ResetQueueTimeStats();
+
 	// NAV Visualizer
 	void VisualizeSolution(FVector source, FVector destination, const TArray<FVector>& PathSolutionRaw, const TArray<FVector>& PathSolutionOptimized, const FDoNNavigationDebugParams& DebugParams);
 
@@ -1226,8 +2066,8 @@ public:
 private:
 
 	// Core pathfinding algorithms
-	void TickScheduledPathfindingTasks(float DeltaSeconds, int32 MaxIterationsPerTick);	
-	void TickScheduledPathfindingTasks_Safe(float DeltaSeconds, int32 MaxIterationsPerTick);
+	void TickScheduledPathfindingTasks(float DeltaSeconds, int32 MaxIterationsPerTick, double TimeBudgetSeconds = 0.0);	
+	void TickScheduledPathfindingTasks_Safe(float DeltaSeconds, int32 MaxIterationsPerTick, double TimeBudgetSeconds = 0.0);
 	void TickScheduledCollisionTasks(float DeltaSeconds, int32 MaxIterationsPerTick);	
 	void TickScheduledCollisionTasks_Safe(float DeltaSeconds, int32 MaxIterationsPerTick);
 
@@ -1235,15 +2075,158 @@ protected:
 	// These virtual functions are overridden for the Finite and Infinite implementations of the plugin (see DonNavigationManager.cpp and DonNavigationManagerUnbound.cpp)
 	virtual void TickNavigationSolver(FDonNavigationQueryTask& task);
 	virtual bool PrepareSolution(FDonNavigationQueryTask& Task);
+	virtual bool PreparePartialSolution(FDonNavigationQueryTask& Task);
 
 private:
 	void TickNavigationOptimizer(FDonNavigationQueryTask& task);
+	bool IsGridLineOfSightClear(const FVector& Start, const FVector& End);
 	void TickNavigationOptimizerCycle(FDonNavigationQueryTask& task, int32& IterationsProcessed, const int32 MaxIterationsPerTask);
 	void TickVoxelCollisionSampler(FDonNavigationDynamicCollisionTask& Task);
 	void ExpandFrontierTowardsTarget(FDonNavigationQueryTask& Task, FDonNavigationVoxel* Current, FDonNavigationVoxel* Neighbor);
+	void ExpandFrontierAnyAngle(FDonNavigationQueryTask& Task, FDonNavigationVoxel* Current, FDonNavigationVoxel* Neighbor);
+	void UpdateAnyAngleParent(FDonNavigationQueryTask& Task, FDonNavigationVoxel* Volume);
+	bool IsGridLineOfSightClearForQuery(FDonNavigationVoxel* From, FDonNavigationVoxel* To, const FDoNNavigationQueryData& QueryData);
 	void PackageRawSolution(FDonNavigationQueryTask& task);
+	bool PackagePartialSolution(FDonNavigationQueryTask& Task);
+	void BuildPathSpline(FDoNNavigationQueryData& Data);
+
+	// Search corridor
+	void BeginSearchCorridorAttempt(FDoNNavigationQueryData& Data);
+	bool WidenSearchCorridor(FDonNavigationQueryTask& Task);
 	void PackageDirectSolution(FDonNavigationQueryTask& Task);
 
+	// Path cache (shared between the game thread and the worker thread, guarded by PathCacheLock)
+	TMap<FDonPathCacheKey, FDonPathCacheEntry> PathCache;
+	TMultiMap<FDonNavigationVoxel*, FDonPathCacheKey> PathCacheVolumeIndex;
+	FCriticalSection PathCacheLock;
+	FThreadSafeCounter PathCacheHits;
+	FThreadSafeCounter PathCacheMisses;
+	FThreadSafeCounter PathCacheInvalidations;
+
+	FDonPathCacheKey PathCacheKeyForQuery(const FDoNNavigationQueryData& QueryData) const;
+	bool ServeFromPathCache(FDonNavigationQueryTask& Task);
+	void AddToPathCache(const FDonNavigationQueryTask& Task);
+	void InvalidatePathCache(const TArray<FDonNavigationVoxel*>& OccupiedVolumes);
+	void RemovePathCacheEntry_Locked(const FDonPathCacheKey& Key);
+
+	// Dynamic collision subscriptions (shared between the game thread and the worker thread, guarded by CollisionSubscriptionLock)
+	TMap<int32, FDonCollisionSubscription> CollisionSubscriptions;
+	TMap<int32, FDonCollisionSubscriberList> CollisionSubscribersByVoxel;
+	FCriticalSection CollisionSubscriptionLock;
+	int32 NextCollisionSubscriptionId = 0;
+
+	FORCEINLINE int32 VoxelIdFor(const FDonNavigationVoxel* Volume) const { return Volume->X + XGridSize * (Volume->Y + YGridSize * Volume->Z); }
+
+	void SubscribeToDynamicCollisions(FDonNavigationQueryTask& Task);
+	void MapPathPointsToVolumes(FDoNNavigationQueryData& Data);
+	void UnsubscribeFromDynamicCollisions(const FDonNavigationDynamicCollisionDelegate& Listener, int32 SubscriptionId);
+	void SetDynamicCollisionPathProgressForSubscription(const FDonNavigationDynamicCollisionDelegate& Listener, int32 SubscriptionId, int32 PathIndex);
+	void StopListeningToDynamicCollisionsForVolume(const FDonNavigationDynamicCollisionDelegate& ListenerToClear, int32 SubscriptionId, FDonNavigationVoxel* Volume, bool bPreciseDynamicCollisionRepathing, const FDonVoxelCollisionProfile& VoxelCollisionProfile);
+	void RemoveCollisionSubscription_Locked(int32 SubscriptionId);
+	void RemoveCollisionSubscribers_Locked(int32 SubscriptionId, const TArray<int32>& VoxelIds);
+	void BroadcastCollisionUpdates(const TArray<FDonNavigationVoxel*>& OccupiedVolumes);
+
+	// Nearest navigable voxel of each blocked voxel resolved so far (shared between the game thread and the worker thread, guarded by NearestNavigableVolumeLock)
+	struct FDonNearestNavigableVolumeCacheEntry
+	{
+		FDonNavigationVoxel* NearestVolume = NULL;
+		TDoubleLinkedList<FDonNavigationVoxel*>::TDoubleLinkedListNode* UsageNode = NULL;
+	};
+
+	TMap<FDonNavigationVoxel*, FDonNearestNavigableVolumeCacheEntry> NearestNavigableVolumeCache;
+
+	/** Cached voxels, most recently used first (the tail is evicted first) */
+	TDoubleLinkedList<FDonNavigationVoxel*> NearestNavigableVolumeUsage;
+
+	/** Cached voxels by coarse cube of the grid, so dynamic collision updates only visit the cubes they touch */
+	TMap<FIntVector, TArray<FDonNavigationVoxel*>> NearestNavigableVolumeBuckets;
+	static const int32 NearestNavigableVolumeBucketSize = 8;
+
+	/** Mirrors NearestNavigableVolumeCache.Num(), so invalidations can skip the lock while nothing is cached */
+	FThreadSafeCounter NumNearestNavigableVolumesCached;
+
+	FCriticalSection NearestNavigableVolumeLock;
+
+	FORCEINLINE FIntVector NearestNavigableVolumeBucket(int32 X, int32 Y, int32 Z) const { return FIntVector(X / NearestNavigableVolumeBucketSize, Y / NearestNavigableVolumeBucketSize, Z / NearestNavigableVolumeBucketSize); }
+
+	FDonNavigationVoxel* FindCachedNearestNavigableVolume(FDonNavigationVoxel* Volume);
+	void CacheNearestNavigableVolume(FDonNavigationVoxel* Volume, FDonNavigationVoxel* NearestVolume);
+	void RemoveCachedNearestNavigableVolume_Locked(FDonNavigationVoxel* Volume);
+	void InvalidateNearestNavigableVolumesForProfile(const FDonVoxelCollisionProfile& Profile, int32 OriginX, int32 OriginY, int32 OriginZ);
+
+	// Query coalescing (owned by whichever thread ticks the pathfinding tasks)
+	TMap<int32, FDonCoalescedSearch> CoalescedSearches;
+	int32 NextCoalescedSearchId = 0;
+
+	void CoalesceNewPathfindingTasks();
+	bool CanJoinCoalescedSearch(const FDoNNavigationQueryData& QueryData, const FDonCoalescedSearch& Search);
+	void JoinCoalescedSearch(FDonNavigationQueryTask& Task, int32 SearchId, FDonCoalescedSearch& Search);
+	void TickCoalescedSearch(FDonCoalescedSearch& Search, int32 MaxIterations);
+	void TickCoalescedQuery(FDonNavigationQueryTask& Task, int32& IterationsProcessed, const int32 MaxIterationsPerTask);
+	bool ExtractCoalescedSolution(FDonNavigationQueryTask& Task, const FDonCoalescedSearch& Search);
+	void ReleaseIdleCoalescedSearches();
+
+	// Scheduling (queue time metrics are written by the solver thread, guarded by QueueTimeStatsLock)
+	struct FDonQueueTimeStats
+	{
+		int32 NumQueries = 0;
+		double TotalQueueTime = 0.0;
+		double MaxQueueTime = 0.0;
+		double TotalTimeToComplete = 0.0;
+		int32 DeadlinesMissed = 0;
+	};
+
+	FDonQueueTimeStats QueueTimeStats[(uint8)EDonNavigationQueryPriority::Num];
+	FCriticalSection QueueTimeStatsLock;
+
+	float SchedulingWeight(const FDoNNavigationQueryData& Data, double Now) const;
+
+	// Time budgeted scheduling (solver thread)
+	double SolverSecondsPerIteration = 0.0; // across all queries, seeds the estimate of new queries
+	int32 IterationQuantumForTimeBudget(const FDoNNavigationQueryData& Data, double TimeBudgetSeconds, int32 FallbackIterations) const;
+	void UpdateSolverCostEstimate(FDoNNavigationQueryData& Data, double SecondsTaken, int32 Iterations);
+	void RecordQueueTimeStats(const FDoNNavigationQueryData& Data, double Now);
+
+	// Results awaiting broadcast (single-threaded only: broadcast once the task loop is done)
+	TArray<FDonNavigationQueryTask*> PendingSynchronousResults;
+
+	// Anytime planning
+	void PublishAnytimeSolution(FDonNavigationQueryTask& Task);
+	void BeginAnytimeRefinement(FDonNavigationQueryTask& Task);
+
+	// Retained searches for path repair
+	TMap<AActor*, int32> RetainedSearchIdByOwner;      // owned by the solver thread
+	TMap<AActor*, FVector> RetainedSearchDestinations; // owned by the game thread
+	TQueue<TArray<FDonNavigationVoxel*>, EQueueMode::Mpsc> RetainedSearchOccupiedVolumes; // from any thread running dynamic collision updates
+
+	void AttachRetainedSearches();
+	void RepairRetainedSearch(FDonCoalescedSearch& Search, FDonNavigationVoxel* NewOrigin);
+	void ReleaseRetainedSearch_Internal(AActor* Actor);
+	void NotifyRetainedSearches(const TArray<FDonNavigationVoxel*>& OccupiedVolumes);
+	void ApplyRetainedSearchNotifications();
+	int32 AgentReachInVoxels(const FDonVoxelCollisionProfile& VoxelCollisionProfile, int32 AgentSizeLayer) const;
+
+	// Flow fields
+	TArray<FDonFlowFieldTask> ActiveFlowFields;            // owned by the solver thread
+	TMap<int32, FDonFlowFieldSnapshotPtr> PublishedFlowFields; // owned by the game thread
+	TSet<int32> ActiveFlowFieldIds;                            // owned by the game thread
+	TQueue<FDonFlowFieldTask> NewFlowFieldTasks;
+	TQueue<FDonFlowFieldSnapshotPtr> CompletedFlowFields;
+	TQueue<FDonFlowFieldDirtyRegion, EQueueMode::Mpsc> DirtyFlowFieldRegions;
+	int32 NextFlowFieldId = 0;
+
+	void AddFlowFieldTask(FDonFlowFieldTask& Task);
+	void AcceptFlowFieldTask(FDonFlowFieldTask& Task);
+	void ReceiveAsyncFlowFieldTasks();
+	void ReceiveAsyncFlowFields();
+	void TickScheduledFlowFieldTasks(int32 MaxIterationsPerTick);
+	void TickScheduledFlowFieldTasks_Safe(int32 MaxIterationsPerTick);
+	void BeginFlowFieldBuild(FDonFlowFieldTask& Task);
+	void PublishFlowField(FDonFlowFieldTask& Task);
+	void InvalidateFlowFields(const FDonFlowFieldDirtyRegion& Region);
+	void ApplyDirtyFlowFieldRegions();
+	void InvalidateFlowFieldsForProfile(const FDonVoxelCollisionProfile& Profile, int32 OriginX, int32 OriginY, int32 OriginZ);
+
 	// Thread-aware routines	
 	//FCriticalSection CriticalSection_Collisions;
 
@@ -1265,14 +2248,13 @@ private:
 
 	// Dynamic collision listeners:
 	void DynamicCollisionUpdateForMesh(const FDonMeshIdentifier& MeshId, FDonVoxelCollisionProfile& VoxelCollisionProfile, bool bDisableCacheUsage = false, bool bDrawDebug = false);
-	void AddCollisionListenerToVolumeFromTask(FDonNavigationVoxel* Volume, FDonNavigationQueryTask& task);
 	FDonNavigationVoxel* AppendVolumeList(FVector Location, FDonNavigationQueryTask& task);
 	void AppendVolumeListFromRange(FVector Start, FVector End, FDonNavigationQueryTask& task);
 
 	// Finite World: (think in terms of Volumes)
 	FDonNavigationVoxel* ResolveVolume(FVector &DesiredLocation, UPrimitiveComponent* CollisionComponent, bool bFlexibleOriginGoal = true, float CollisionShapeInflation = 0.f, bool bShouldSweep = true);	
 	FDonNavigationVoxel* GetClosestNavigableVolume(FVector DesiredLocation, UPrimitiveComponent* CollisionComponent, bool &bInitialPositionCollides, float CollisionShapeInflation = 0.f, bool bShouldSweep = true);	
-	FDonNavigationVoxel* GetBestNeighborRecursive(FDonNavigationVoxel* Volume, int32 CurrentDepth, int32 NeighborSearchMaxDepth, FVector Location, UPrimitiveComponent* CollisionComponent, bool bConsiderInitialOverlaps, float CollisionShapeInflation, bool bShouldSweep);
+	FDonNavigationVoxel* FindNearestNavigableVolume(FDonNavigationVoxel* Volume, int32 MaxRadius, FVector Location, UPrimitiveComponent* CollisionComponent, bool bConsiderInitialOverlaps, float CollisionShapeInflation, bool bShouldSweep);
 
 	// Infinite World: (think in terms of Vectors)
 	bool ResolveVector(FVector &DesiredLocation, FVector &ResolvedLocation, UPrimitiveComponent* CollisionComponent, bool bFlexibleOriginGoal = true, float CollisionShapeInflation = 0.f, bool bShouldSweep = true);
@@ -1284,10 +2266,103 @@ public:
 
 	bool CanNavigate(FDonNavigationVoxel* Volume);
 
+	/** Distance (in voxels) from the voxel at Location to the nearest obstacle or world boundary, capped at MaxClearanceVoxels. 0 means the voxel itself is blocked, -1 an invalid location */
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	int32 GetClearanceAtLocation(FVector Location);
+
+	uint8 GetVoxelClearance(FDonNavigationVoxel* Volume);
+
+	/** Index of the agent size class layer that will be used for queries by this collision profile (INDEX_NONE if none applies) */
+	int32 SelectAgentSizeLayer(const FDonVoxelCollisionProfile& CollisionProfile) const;
+
+	bool IsNavigableInLayer(FDonNavigationVoxel* Volume, int32 Layer);
+
+	/** 
+	* Bound worlds only. Whether the segment Start -> End crosses navigable voxels only, for a pawn extending AgentRadiusVoxels voxels around its center (0 = a single voxel).
+	* This is an exact walk of the voxel grid with no physics queries, so it is far cheaper than a sweep but only as accurate as the voxel size.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	bool IsSegmentClearInGrid(FVector Start, FVector End, int32 AgentRadiusVoxels = 0);
+
+	/** Bound worlds only. Centers of every voxel crossed by the segment Start -> End, in order, each exactly once */
+	UFUNCTION(BlueprintCallable, Category = "DoN Navigation")
+	TArray<FVector> GetVoxelsAlongSegment(FVector Start, FVector End);
+
+	/** Whether the voxel and every voxel within Radius of it (Chebyshev distance) is navigable */
+	bool IsNavigableForAgentRadius(FDonNavigationVoxel* Volume, int32 Radius);
+
+	/**
+	* Visits every voxel crossed by the segment Start -> End in order (Amanatides-Woo traversal), each exactly once and with no gaps between consecutive voxels.
+	* Voxels outside the world are visited as NULL. The visitor returns false to stop the walk early, in which case this returns false as well.
+	*/
+	template<typename VisitorType>
+	bool ForEachVoxelAlongSegment(const FVector& Start, const FVector& End, VisitorType&& Visitor)
+	{
+		const FVector gridOrigin = GetActorLocation();
+		const FVector a = (Start - gridOrigin) / VoxelSize;
+		const FVector b = (End - gridOrigin) / VoxelSize;
+		const FVector delta = b - a;
+
+		int32 x = FMath::FloorToInt(a.X), y = FMath::FloorToInt(a.Y), z = FMath::FloorToInt(a.Z);
+		const int32 stepX = delta.X > 0 ? 1 : (delta.X < 0 ? -1 : 0);
+		const int32 stepY = delta.Y > 0 ? 1 : (delta.Y < 0 ? -1 : 0);
+		const int32 stepZ = delta.Z > 0 ? 1 : (delta.Z < 0 ? -1 : 0);
+
+		// Distance along the segment (as a fraction of its length) between voxel boundaries on each axis, and to the next boundary crossed:
+		const double tDeltaX = stepX ? FMath::Abs(1.0 / delta.X) : TNumericLimits<double>::Max();
+		const double tDeltaY = stepY ? FMath::Abs(1.0 / delta.Y) : TNumericLimits<double>::Max();
+		const double tDeltaZ = stepZ ? FMath::Abs(1.0 / delta.Z) : TNumericLimits<double>::Max();
+		double tMaxX = stepX ? (stepX > 0 ? x + 1 - a.X : a.X - x) * tDeltaX : TNumericLimits<double>::Max();
+		double tMaxY = stepY ? (stepY > 0 ? y + 1 - a.Y : a.Y - y) * tDeltaY : TNumericLimits<double>::Max();
+		double tMaxZ = stepZ ? (stepZ > 0 ? z + 1 - a.Z : a.Z - z) * tDeltaZ : TNumericLimits<double>::Max();
+
+		// Every step crosses exactly one boundary, so the walk ends in the voxel holding End:
+		const int32 numSteps = FMath::Abs(FMath::FloorToInt(b.X) - x) + FMath::Abs(FMath::FloorToInt(b.Y) - y) + FMath::Abs(FMath::FloorToInt(b.Z) - z);
+
+		for (int32 step = 0; ; step++)
+		{
+			if (!Visitor(VolumeAtSafe(x, y, z)))
+				return false;
+
+			if (step == numSteps)
+				return true;
+
+			if (tMaxX < tMaxY && tMaxX < tMaxZ)
+			{
+				x += stepX;
+				tMaxX += tDeltaX;
+			}
+			else if (tMaxY < tMaxZ)
+			{
+				y += stepY;
+				tMaxY += tDeltaY;
+			}
+			else
+			{
+				z += stepZ;
+				tMaxZ += tDeltaZ;
+			}
+		}
+	}
+
 protected:
 	bool CanNavigateByCollisionProfile(FDonNavigationVoxel* Volume, const FDonVoxelCollisionProfile& CollisionToTest);
 	bool CanNavigateByCollisionProfile(FVector Location, const FDonVoxelCollisionProfile& CollisionToTest);
 
+	/** Navigability of a voxel for the pawn behind a query: uses the query's agent size layer when it has one, its collision profile otherwise */
+	bool CanNavigateForQuery(FDonNavigationVoxel* Volume, const FDoNNavigationQueryData& QueryData);
+	bool CanNavigateForAgent(FDonNavigationVoxel* Volume, const FDonVoxelCollisionProfile& VoxelCollisionProfile, int32 AgentSizeLayer);
+
+	// Clearance field and agent size layers (derived from the base occupancy):
+	FThreadSafeBool bHasDerivedOccupancyData = false;
+
+	/** Bumped by every invalidation of derived occupancy. Derived values are computed lazily from any thread, so a value computed while an invalidation ran
+	*   (possibly from occupancy that has since changed) is discarded again instead of outliving it. See GetVoxelClearance and IsNavigableInLayer. */
+	FThreadSafeCounter DerivedOccupancyGeneration;
+	bool IsClearanceShellNavigable(FDonNavigationVoxel* Volume, int32 Radius);
+	void InvalidateDerivedOccupancy(int32 MinX, int32 MinY, int32 MinZ, int32 MaxX, int32 MaxY, int32 MaxZ);
+	void InvalidateDerivedOccupancyForProfile(const FDonVoxelCollisionProfile& Profile, int32 OriginX, int32 OriginY, int32 OriginZ);
+
 private:
 
 	// Path solution generation and optimization pass
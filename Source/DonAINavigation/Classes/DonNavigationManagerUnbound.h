@@ -35,6 +35,7 @@ public:
 protected:
 	virtual void TickNavigationSolver(FDonNavigationQueryTask& task) override;
 	virtual bool PrepareSolution(FDonNavigationQueryTask& Task) override;
+	virtual bool PreparePartialSolution(FDonNavigationQueryTask& Task) override;
 
 	TArray<FVector> NeighborsAsVectors(FVector Location);
 	void ExpandFrontierTowardsTarget(FDonNavigationQueryTask& Task, FVector Current, FVector Neighbor);	
@@ -0,0 +1,66 @@
+// The MIT License(MIT)
+//
+// Copyright(c) 2015 Venugopalan Sreedharan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), 
+// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+// and / or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+
+/**
+* Smoothed form of a path solution: a centripetal Catmull-Rom spline through the path points, sampled into a dense polyline along with
+* a cumulative arc-length table. Location and direction at a given distance along the path are then a binary search away.
+*
+* Spans that fail the collision test given to Build() are kept straight, so the curve never strays from space the path itself was proven clear in.
+* Built once on the navigation worker and shared read-only with whoever follows the path (see FDonNavigationPathResult::Spline).
+*/
+struct DONAINAVIGATION_API FDonNavigationPathSpline
+{
+	typedef TFunctionRef<bool(const FVector& Start, const FVector& End)> FSegmentTest;
+
+	/** Fits the spline through Points, sampling each span SamplesPerSpan times. A span is curved only if IsSegmentClear passes for all its samples */
+	void Build(const TArray<FVector>& Points, int32 SamplesPerSpan, FSegmentTest IsSegmentClear);
+
+	bool IsValid() const { return Samples.Num() >= 2; }
+
+	float GetLength() const { return Distances.Num() ? Distances.Last() : 0.f; }
+
+	FVector GetLocationAtDistance(float Distance) const;
+
+	/** Unit direction of travel at the given distance */
+	FVector GetDirectionAtDistance(float Distance) const;
+
+	/** Distance along the spline of the path point at PointIndex (as passed to Build) */
+	float GetDistanceOfPoint(int32 PointIndex) const { return PointDistances.IsValidIndex(PointIndex) ? PointDistances[PointIndex] : GetLength(); }
+
+	/** Distance of the point on the spline closest to Location, searching only from StartDistance up to StartDistance + SearchLength */
+	float FindDistanceClosestTo(const FVector& Location, float StartDistance, float SearchLength) const;
+
+	/** The sampled curve, for visualization */
+	const TArray<FVector>& GetSamples() const { return Samples; }
+
+	int32 GetNumStraightenedSpans() const { return NumStraightenedSpans; }
+
+private:
+	/** Index of the sample segment containing Distance */
+	int32 FindSegment(float Distance) const;
+
+	TArray<FVector> Samples;
+
+	/** Cumulative arc length at each sample */
+	TArray<float> Distances;
+
+	TArray<float> PointDistances;
+
+	int32 NumStraightenedSpans = 0;
+};
@@ -0,0 +1,61 @@
+// The MIT License(MIT)
+//
+// Copyright(c) 2015 Venugopalan Sreedharan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), 
+// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+// and / or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+
+#include "DonNavigationSubsystem.generated.h"
+
+class ADonNavigationManager;
+
+/**
+* Registry of the navigation managers playing in a world. Managers register themselves on BeginPlay and unregister on EndPlay,
+* so finding the manager for an agent is a lookup over a handful of cached bounds instead of an iteration over every actor in the world.
+*/
+UCLASS()
+class DONAINAVIGATION_API UDonNavigationSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	void RegisterManager(ADonNavigationManager* Manager);
+	void UnregisterManager(ADonNavigationManager* Manager);
+
+	/** Returns the manager whose navigable world contains Location. Where finite worlds overlap the smallest one wins; infinite worlds are the fallback */
+	UFUNCTION(BlueprintPure, Category = "DoN Navigation")
+	ADonNavigationManager* GetManagerForLocation(FVector Location) const;
+
+	/** Returns any registered manager (finite worlds first) */
+	UFUNCTION(BlueprintPure, Category = "DoN Navigation")
+	ADonNavigationManager* GetAnyManager() const;
+
+	bool HasRegisteredManagers() const { return BoundManagers.Num() || UnboundManagers.Num(); }
+
+private:
+
+	struct FBoundManagerEntry
+	{
+		TWeakObjectPtr<ADonNavigationManager> Manager;
+
+		/** Navigable world of the manager, as of its registration. Used to prefilter lookups, see GetManagerForLocation */
+		FBox Bounds;
+	};
+
+	/** Finite worlds, smallest first */
+	TArray<FBoundManagerEntry> BoundManagers;
+
+	TArray<TWeakObjectPtr<ADonNavigationManager>> UnboundManagers;
+};
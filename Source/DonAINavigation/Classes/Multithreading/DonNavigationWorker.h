@@ -27,7 +27,7 @@ class FDonNavigationWorker: public FRunnable
 
 public:
 	FDonNavigationWorker();
-	FDonNavigationWorker(ADonNavigationManager* Manager, int32 MaxPathSolverIterations, int32 MaxCollisionSolverIterations);
+	FDonNavigationWorker(ADonNavigationManager* Manager, int32 MaxPathSolverIterations, int32 MaxCollisionSolverIterations, int32 MaxFlowFieldIterations, double PathSolverTimeBudget);
 	virtual ~FDonNavigationWorker();	
 
 	//FRunnable interface
@@ -44,4 +44,6 @@ private:
 	
 	int32 MaxPathSolverIterations;
 	int32 MaxCollisionSolverIterations;
+	int32 MaxFlowFieldIterations;
+	double PathSolverTimeBudget; // seconds, 0 if the path solver is budgeted by iterations
 };
@@ -77,7 +77,7 @@ EBTNodeResult::Type UBTTask_FlyTo::ExecuteTask(UBehaviorTreeComponent& OwnerComp
 	return NodeResult;
 }
 
-EBTNodeResult::Type UBTTask_FlyTo::SchedulePathfindingRequest(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory,  bool isMovingTargetRepath)
+EBTNodeResult::Type UBTTask_FlyTo::SchedulePathfindingRequest(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory,  bool isMovingTargetRepath, bool bRepairPath)
 {
 	auto pawn        =  OwnerComp.GetAIOwner()->GetPawn();
 	auto myMemory    =  (FBT_FlyToTarget*)NodeMemory;
@@ -90,7 +90,7 @@ EBTNodeResult::Type UBTTask_FlyTo::SchedulePathfindingRequest(UBehaviorTreeCompo
 	else
 		LastRequestTimestamps.Add(pawn, currentTime); //LastRequestTimestamp = currentTime;
 		*/
-	NavigationManager =  UDonNavigationHelper::DonNavigationManagerForActor(pawn);
+	NavigationManager = NavigationManagerForPawn(pawn, myMemory);
 	if (!NavigationManager)
 	{
 		UE_LOG(DoNNavigationLog, Error, TEXT("BTTask_FlyTo did not find NavigationManager for the pawn."));
@@ -175,7 +175,13 @@ EBTNodeResult::Type UBTTask_FlyTo::SchedulePathfindingRequest(UBehaviorTreeCompo
 
 	// Schedule task:
 	bool bTaskScheduled = false;
-	bTaskScheduled = NavigationManager->SchedulePathfindingTask(pawn, flightDestination, myMemory->QueryParams, DebugParams, resultHandler, myMemory->DynamicCollisionListener);
+
+	// Repairing a path only re-solves the part of the retained search invalidated by dynamic obstacles:
+	if (bRepairPath && myMemory->QueryParams.bRetainSearchForRepair)
+		bTaskScheduled = NavigationManager->RepairPathfindingTask(pawn, myMemory->QueryParams, DebugParams, resultHandler, myMemory->DynamicCollisionListener);
+
+	if (!bTaskScheduled)
+		bTaskScheduled = NavigationManager->SchedulePathfindingTask(pawn, flightDestination, myMemory->QueryParams, DebugParams, resultHandler, myMemory->DynamicCollisionListener);
 
 	if (bTaskScheduled)
 	{
@@ -193,9 +199,10 @@ void UBTTask_FlyTo::AbortPathfindingRequest(UBehaviorTreeComponent& OwnerComp, u
 	if (NavigationManager && pawn && myMemory)
 	{
 		NavigationManager->AbortPathfindingTask(pawn);
+		NavigationManager->ReleaseRetainedSearch(pawn);
 
 		// Unregister all dynamic collision listeners. We've completed our task and are no longer interested in listening to these:
-		NavigationManager->StopListeningToDynamicCollisionsForPath(myMemory->DynamicCollisionListener, myMemory->QueryResults);
+		NavigationManager->StopListeningToDynamicCollisionsForPathResult(myMemory->DynamicCollisionListener, myMemory->QueryResults);
 	}
 }
 
@@ -242,8 +249,12 @@ void UBTTask_FlyTo::Pathfinding_OnFinish(const FDoNNavigationQueryData& Data)
 	if (myMemory == nullptr || myMemory->Metadata.OwnerComp == nullptr)
 		return;
 
-	// Store query results:	
-	myMemory->QueryResults = Data;
+	// Is this a refined path replacing a provisional one we're already flying along? (anytime planning)
+	const bool bReplacingProvisionalPath = myMemory->QueryResults.IsValid() && !myMemory->QueryResults->bIsFinalResult && myMemory->Path().Num() > 0;
+
+	// Store query results (only the compact shared result is kept, not the query data):
+	myMemory->QueryStatus = Data.QueryStatus;
+	myMemory->QueryResults = Data.Result;
 	
 	TWeakObjectPtr<UBehaviorTreeComponent> ownerComp = myMemory->Metadata.OwnerComp;
 
@@ -257,22 +268,63 @@ void UBTTask_FlyTo::Pathfinding_OnFinish(const FDoNNavigationQueryData& Data)
 		if (bTeleportToDestinationUponFailure && ownerComp.IsValid())
 		{
 			TeleportAndExit(*ownerComp, false);
-			myMemory->QueryResults.QueryStatus = EDonNavigationQueryStatus::Success;
+			myMemory->QueryStatus = EDonNavigationQueryStatus::Success;
 		}
 		else
 		{
 			UE_LOG(DoNNavigationLog, Log, TEXT("Found empty pathsolution in Fly To node. Aborting task..."));
-			myMemory->QueryResults.QueryStatus = EDonNavigationQueryStatus::Failure;
+			myMemory->QueryStatus = EDonNavigationQueryStatus::Failure;
 		}
 
 		return;
 	}
 
+	// Locomotion is already under way, resume from the point of the new path nearest to the pawn:
+	if (bReplacingProvisionalPath)
+	{
+		APawn* pawn = ownerComp.IsValid() && ownerComp->GetAIOwner() ? ownerComp->GetAIOwner()->GetPawn() : NULL;
+		if (!pawn)
+			return;
+
+		const FVector pawnLocation = pawn->GetActorLocation();
+		const auto& path = Data.PathSolutionOptimized;
+
+		int32 nearestIndex = 0;
+		float nearestDistSq = TNumericLimits<float>::Max();
+
+		for (int32 i = 0; i < path.Num(); i++)
+		{
+			const float distSq = FVector::DistSquared(pawnLocation, path[i]);
+			if (distSq < nearestDistSq)
+			{
+				nearestDistSq = distSq;
+				nearestIndex = i;
+			}
+		}
+
+		// Already past the nearest point? (closer to the next point than the nearest point itself is)
+		if (nearestIndex < path.Num() - 1 && FVector::DistSquared(pawnLocation, path[nearestIndex + 1]) < FVector::DistSquared(path[nearestIndex], path[nearestIndex + 1]))
+			nearestIndex++;
+
+		myMemory->solutionTraversalIndex = nearestIndex;
+
+		if (Data.Result.IsValid() && Data.Result->Spline.IsValid())
+			myMemory->SplineDistance = Data.Result->Spline->FindDistanceClosestTo(pawnLocation, 0.f, Data.Result->Spline->GetLength());
+
+		if (myMemory->bIsANavigator)
+			IDonNavigator::Execute_OnNextSegment(pawn, path[nearestIndex]);
+
+		return;
+	}
+
 	// If we're a moving target repath, then skip the first index because the first index will generally just be
 	//  from the pawn start to the closest nav voxel and may cause us to move backwards.
 	if (myMemory->isMovingTargetRepath && Data.PathSolutionOptimized.Num() >= 2)
 		myMemory->solutionTraversalIndex = 1;
 
+	if (Data.Result.IsValid() && Data.Result->Spline.IsValid())
+		myMemory->SplineDistance = Data.Result->Spline->GetDistanceOfPoint(FMath::Max(myMemory->solutionTraversalIndex - 1, 0));
+
 	// Inform pawn owner that we're about to start locomotion!
 	if (myMemory->bIsANavigator)
 	{
@@ -284,7 +336,7 @@ void UBTTask_FlyTo::Pathfinding_OnFinish(const FDoNNavigationQueryData& Data)
 		IDonNavigator::Execute_OnLocomotionBegin(pawn);
 
 		//UE_LOG(DoNNavigationLog, Verbose, TEXT("Segment 0"));
-		IDonNavigator::Execute_OnNextSegment(pawn, myMemory->QueryResults.PathSolutionOptimized[0]);
+		IDonNavigator::Execute_OnNextSegment(pawn, myMemory->Path()[0]);
 	}
 
 }
@@ -304,7 +356,7 @@ void UBTTask_FlyTo::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemor
 	FBT_FlyToTarget* myMemory = (FBT_FlyToTarget*)NodeMemory;
 
 	APawn* pawn = OwnerComp.GetAIOwner()->GetPawn();
-	NavigationManager = UDonNavigationHelper::DonNavigationManagerForActor(pawn);
+	NavigationManager = NavigationManagerForPawn(pawn, myMemory);
 
 	if (NavigationManager == nullptr)
 	{
@@ -313,7 +365,7 @@ void UBTTask_FlyTo::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemor
 	}
 
 	// If I'm still waiting to get a path to my target, just return:
-	if (EDonNavigationQueryStatus::InProgress == myMemory->QueryResults.QueryStatus)
+	if (EDonNavigationQueryStatus::InProgress == myMemory->QueryStatus)
 		return;
 
 	// If my actor target has moved beyond the threshold, I should recalculate my path towards it:
@@ -325,18 +377,20 @@ void UBTTask_FlyTo::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemor
 		return;
 	}
 
-	switch (myMemory->QueryResults.QueryStatus)
+	switch (myMemory->QueryStatus)
 	{
 
 	case EDonNavigationQueryStatus::Success:
+	case EDonNavigationQueryStatus::PartialSuccess:
 
 		// Is our path solution no longer valid?
 		if (myMemory->bSolutionInvalidatedByDynamicObstacle)
 		{
-			NavigationManager->StopListeningToDynamicCollisionsForPath(myMemory->DynamicCollisionListener, myMemory->QueryResults);
+			NavigationManager->StopListeningToDynamicCollisionsForPathResult(myMemory->DynamicCollisionListener, myMemory->QueryResults);
 
 			// Recalculate path (a dynamic obstacle has probably come out of nowhere and invalidated our current solution)
-			EBTNodeResult::Type bRes = SchedulePathfindingRequest(OwnerComp, NodeMemory);
+			const bool bRepairPath = true;
+			EBTNodeResult::Type bRes = SchedulePathfindingRequest(OwnerComp, NodeMemory, false, bRepairPath);
 			if (bRes == EBTNodeResult::Failed)
 				FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
 
@@ -357,10 +411,6 @@ void UBTTask_FlyTo::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemor
 
 		break;
 
-	// For advanced usecases we could support partial path traversal, etc (so we slowly progress towards the goal
-	// with each cycle of query-timeout->partial-reschedule->partial-navigate->query-timeout->partial-reschedule, etc)
-	// but for now, let's just keep things simple.
-
 	case EDonNavigationQueryStatus::QueryHasNoSolution:
 	case EDonNavigationQueryStatus::TimedOut:
 	case EDonNavigationQueryStatus::Failure:
@@ -379,24 +429,63 @@ bool UBTTask_FlyTo::CheckTargetMoved(FBT_FlyToTarget* MyMemory)
 	return MyMemory->TargetActor != nullptr && bRecalcPathOnDestinationChanged && FVector::DistSquared(MyMemory->TargetLocation, MyMemory->TargetActor->GetActorLocation()) >= FMath::Square(this->RecalculatePathTolerance);
 }
 
+ADonNavigationManager* UBTTask_FlyTo::NavigationManagerForPawn(APawn* Pawn, FBT_FlyToTarget* MyMemory)
+{
+	if (!Pawn)
+		return nullptr;
+
+	if (!MyMemory)
+		return UDonNavigationHelper::DonNavigationManagerForActor(Pawn);
+
+	// Still within the manager we found last time? (a bounds check, much cheaper than looking the manager up again every tick)
+	ADonNavigationManager* manager = MyMemory->CachedNavigationManager.Get();
+	if (manager && manager->IsLocationWithinNavigableWorld(Pawn->GetActorLocation()))
+		return manager;
+
+	manager = UDonNavigationHelper::DonNavigationManagerForActor(Pawn);
+	MyMemory->CachedNavigationManager = manager;
+
+	return manager;
+}
+
 void UBTTask_FlyTo::TickPathNavigation(UBehaviorTreeComponent& OwnerComp, FBT_FlyToTarget* MyMemory, float DeltaSeconds)
 {
-	const auto& queryResults = MyMemory->QueryResults;
+	// (a local reference keeps the path alive even if a re-query replaces it below)
+	const FDonNavigationPathResultPtr queryResults = MyMemory->QueryResults;
+	const TArray<FVector>& path = MyMemory->Path();
 
 	APawn* pawn = OwnerComp.GetAIOwner()->GetPawn();
 
 	if (DebugParams.bVisualizePawnAsVoxels)
 		NavigationManager->Debug_DrawVoxelCollisionProfile(Cast<UPrimitiveComponent>(pawn->GetRootComponent()));
 
-	if (!queryResults.PathSolutionOptimized.IsValidIndex(MyMemory->solutionTraversalIndex))
+	if (!path.IsValidIndex(MyMemory->solutionTraversalIndex))
 	{
 		HandleTaskFailureAndExit(OwnerComp, (uint8*) (MyMemory)); // observed after recent multi-threading rewrite. Need to watch this branch closely and understand why it occurs!
 		return;
 	}
 
-	FVector deltaToNextNode = queryResults.PathSolutionOptimized[MyMemory->solutionTraversalIndex] - pawn->GetActorLocation();
+	const FVector pawnLocation = pawn->GetActorLocation();
+	FVector deltaToNextNode = path[MyMemory->solutionTraversalIndex] - pawnLocation;
 	FVector nextNodeDirection = deltaToNextNode.GetSafeNormal();
 
+	// Following a path spline? Steer towards a point a little ahead on the curve instead of flying corner to corner:
+	const FDonNavigationPathSpline* spline = queryResults.IsValid() ? queryResults->Spline.Get() : NULL;
+	bool bPassedNextNodeOnSpline = false;
+
+	if (spline)
+	{
+		MyMemory->SplineDistance = spline->FindDistanceClosestTo(pawnLocation, MyMemory->SplineDistance, 2.f * SplineLookAheadDistance);
+
+		const FVector steeringTarget = spline->GetLocationAtDistance(MyMemory->SplineDistance + SplineLookAheadDistance);
+		const FVector steeringDirection = (steeringTarget - pawnLocation).GetSafeNormal();
+		if (!steeringDirection.IsZero())
+			nextNodeDirection = steeringDirection;
+
+		// The lookahead rounds corners, so intermediate points count as reached once they're behind us on the spline:
+		bPassedNextNodeOnSpline = MyMemory->solutionTraversalIndex < path.Num() - 1 && MyMemory->SplineDistance >= spline->GetDistanceOfPoint(MyMemory->solutionTraversalIndex);
+	}
+
 	//auto navigator = Cast<IDonNavigator>(pawn);
 
 	// Add movement input:
@@ -414,10 +503,33 @@ void UBTTask_FlyTo::TickPathNavigation(UBehaviorTreeComponent& OwnerComp, FBT_Fl
 	//UE_LOG(DoNNavigationLog, Verbose, TEXT("Segment %d Distance: %f"), MyMemory->solutionTraversalIndex, flightDirection.Size());
 
 	// Reached next segment:
-	if (deltaToNextNode.Size() <= MinimumProximityRequired)
+	if (deltaToNextNode.Size() <= MinimumProximityRequired || bPassedNextNodeOnSpline)
 	{
+		// End of a partial path? Query again from here, so long as we keep getting closer to the goal:
+		if (MyMemory->solutionTraversalIndex == path.Num() - 1 && MyMemory->QueryStatus == EDonNavigationQueryStatus::PartialSuccess)
+		{
+			NavigationManager->StopListeningToDynamicCollisionsForPathResult(MyMemory->DynamicCollisionListener, queryResults);
+
+			const float remainingDistance = FVector::Dist(pawn->GetActorLocation(), MyMemory->TargetLocation);
+
+			if (remainingDistance >= MyMemory->PartialPathRemainingDistance)
+			{
+				UE_LOG(DoNNavigationLog, Log, TEXT("Partial path made no progress towards the goal. Aborting task..."));
+				HandleTaskFailureAndExit(OwnerComp, (uint8*)MyMemory);
+				return;
+			}
+
+			EBTNodeResult::Type bRes = SchedulePathfindingRequest(OwnerComp, (uint8*)MyMemory);
+			if (bRes == EBTNodeResult::Failed)
+				FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+			else
+				MyMemory->PartialPathRemainingDistance = remainingDistance; // (set after scheduling, which resets the node memory)
+
+			return;
+		}
+
 		// Goal reached?
-		if (MyMemory->solutionTraversalIndex == queryResults.PathSolutionOptimized.Num() - 1)
+		if (MyMemory->solutionTraversalIndex == path.Num() - 1)
 		{
 			auto controller = pawn->GetController();
 			auto blackboard = controller ? controller->FindComponentByClass<UBlackboardComponent>() : NULL;
@@ -428,7 +540,12 @@ void UBTTask_FlyTo::TickPathNavigation(UBehaviorTreeComponent& OwnerComp, FBT_Fl
 			}
 
 			// Unregister all dynamic collision listeners. We've completed our task and are no longer interested in listening to these:
-			NavigationManager->StopListeningToDynamicCollisionsForPath(MyMemory->DynamicCollisionListener, queryResults);
+			NavigationManager->StopListeningToDynamicCollisionsForPathResult(MyMemory->DynamicCollisionListener, queryResults);
+			NavigationManager->ReleaseRetainedSearch(pawn);
+
+			// Arrived on a provisional anytime path, no point refining it any further:
+			if (!queryResults->bIsFinalResult)
+				NavigationManager->AbortPathfindingTask(pawn);
 
 			// Inform the pawn owner that we're stopping locomotion (having reached the destination!)
 			if (MyMemory->bIsANavigator)
@@ -442,10 +559,10 @@ void UBTTask_FlyTo::TickPathNavigation(UBehaviorTreeComponent& OwnerComp, FBT_Fl
 		{
 			MyMemory->solutionTraversalIndex++;
 
-			// Because we just completed a segment, we should stop listening to collisions on the previous voxel.
+			// Because we just completed a segment, we should stop listening to collisions on the voxels behind us.
 			// If not, a pawn may needlessly recalculate its solution when a obstacle far behind it intrudes on a voxel it has already visited.
-			if (!NavigationManager->bIsUnbound && queryResults.VolumeSolutionOptimized.IsValidIndex(MyMemory->solutionTraversalIndex - 1))
-				NavigationManager->StopListeningToDynamicCollisionsForPathIndex(MyMemory->DynamicCollisionListener, queryResults, MyMemory->solutionTraversalIndex - 1);
+			if (!NavigationManager->bIsUnbound)
+				NavigationManager->SetDynamicCollisionPathResultProgress(MyMemory->DynamicCollisionListener, queryResults, MyMemory->solutionTraversalIndex - 1);
 
 			if (MyMemory->bIsANavigator)
 			{
@@ -455,9 +572,9 @@ void UBTTask_FlyTo::TickPathNavigation(UBehaviorTreeComponent& OwnerComp, FBT_Fl
 					return;
 				}
 
-				if (queryResults.PathSolutionOptimized.IsValidIndex(MyMemory->solutionTraversalIndex))
+				if (path.IsValidIndex(MyMemory->solutionTraversalIndex))
 				{
-					FVector nextPoint = queryResults.PathSolutionOptimized[MyMemory->solutionTraversalIndex];
+					FVector nextPoint = path[MyMemory->solutionTraversalIndex];
 					//UE_LOG(DoNNavigationLog, Verbose, TEXT("Segment %d, %s"), MyMemory->solutionTraversalIndex, *nextPoint.ToString());
 
 					IDonNavigator::Execute_OnNextSegment(pawn, nextPoint);
@@ -565,7 +682,7 @@ EBTNodeResult::Type UBTTask_FlyTo::AbortTask(UBehaviorTreeComponent& OwnerComp,
 	FBT_FlyToTarget* myMemory = (FBT_FlyToTarget*)NodeMemory;
 
 	// Notify locomotion state:
-	if (myMemory->QueryResults.PathSolutionOptimized.Num() && myMemory->bIsANavigator && pawn)
+	if (myMemory->Path().Num() && myMemory->bIsANavigator && pawn)
 		IDonNavigator::Execute_OnLocomotionAbort(pawn);
 
 	return Super::AbortTask(OwnerComp, NodeMemory);
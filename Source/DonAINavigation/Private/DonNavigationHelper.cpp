@@ -14,6 +14,7 @@
 
 #include "DonNavigationHelper.h"
 #include "DonAINavigationPrivatePCH.h"
+#include "DonNavigationSubsystem.h"
 
 ADonNavigationManager* UDonNavigationHelper::DonNavigationManager(UObject* WorldContextObject)
 {
@@ -21,6 +22,12 @@ ADonNavigationManager* UDonNavigationHelper::DonNavigationManager(UObject* World
 	if (!World)
 		return NULL;
 
+	// Managers register with the world's navigation subsystem once they begin play:
+	auto subsystem = World->GetSubsystem<UDonNavigationSubsystem>();
+	if (subsystem && subsystem->HasRegisteredManagers())
+		return subsystem->GetAnyManager();
+
+	// (not yet playing, eg: editor utilities)
 	for (TActorIterator<ADonNavigationManager> It(World, ADonNavigationManager::StaticClass()); It; ++It)
 	{
 		return *It;
@@ -34,6 +41,14 @@ ADonNavigationManager* UDonNavigationHelper::DonNavigationManagerForActor(const
 	if (!Actor)
 		return nullptr;
 
+	UWorld* const World = Actor->GetWorld();
+	if (!World)
+		return nullptr;
+
+	auto subsystem = World->GetSubsystem<UDonNavigationSubsystem>();
+	if (subsystem && subsystem->HasRegisteredManagers())
+		return subsystem->GetManagerForLocation(Actor->GetActorLocation());
+
 	for (TActorIterator<ADonNavigationManager> It(Actor->GetWorld(), ADonNavigationManager::StaticClass()); It; ++It) {
 		const ADonNavigationManager *Mgr = *It;
 		if (Mgr->IsLocationWithinNavigableWorld(Actor->GetActorLocation()))
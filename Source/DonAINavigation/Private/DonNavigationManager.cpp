@@ -15,6 +15,10 @@
 #include "DonNavigationManager.h"
 #include "DonAINavigationPrivatePCH.h"
 #include "Multithreading/DonNavigationWorker.h"
+#include "DonNavigationSubsystem.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Unique.h"
 
 #include <stdio.h>
 #include <limits>
@@ -25,15 +29,6 @@ DECLARE_CYCLE_STAT(TEXT("DonNavigation ~ DynamicCollisionSampling"), STAT_Dynami
 
 #define DEBUG_DoNAI_THREADS 0
 
-void FDonNavigationVoxel::BroadcastCollisionUpdates()
-{
-	// Protect ourselves from delegate owners reallocating the TArray while we're iterating:
-	auto notifyees_safecopy = DynamicCollisionNotifyees; 
-
-	for (const auto& notifyee : notifyees_safecopy)
-		notifyee.Listener.ExecuteIfBound(notifyee.Payload);
-}
-
 ADonNavigationManager::ADonNavigationManager(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
 	// Scene Component
@@ -133,13 +128,18 @@ void ADonNavigationManager::Tick(float DeltaSeconds)
 
 	if (!bMultiThreadingEnabled)
 	{
-		TickScheduledPathfindingTasks(DeltaSeconds, MaxPathSolverIterationsPerTick);
+		TickScheduledPathfindingTasks(DeltaSeconds, MaxPathSolverIterationsPerTick, bUsePathSolverTimeBudget ? PathSolverTimeBudgetPerTickMicroseconds * 1e-6 : 0.0);
 
 		TickScheduledCollisionTasks(DeltaSeconds, MaxCollisionSolverIterationsPerTick);
+
+		TickScheduledFlowFieldTasks(MaxFlowFieldIterationsPerTick);
+
+		ReceiveAsyncDynamicCollisionUpdates();
 	}
 	else
 	{
 		ReceiveAsyncResults();
+		ReceiveAsyncFlowFields();
 		ReceiveAsyncDynamicCollisionUpdates();
 		DrawAsyncDebugRequests();	
 	}
@@ -147,17 +147,23 @@ void ADonNavigationManager::Tick(float DeltaSeconds)
 
 void ADonNavigationManager::ReceiveAsyncResults()
 {
-	while (!CompletedNavigationTasks.IsEmpty())
+	// Drain every result available in one batch
+	FDonNavigationQueryTask* task;
+
+	while (CompletedNavigationTasks.Dequeue(task))
 	{
-		FDonNavigationQueryTask task;
-		CompletedNavigationTasks.Dequeue(task);
-		ActiveNavigationTaskOwners.Remove(task.Data.Actor.Get());
-		task.BroadcastResult();
+		// Provisional anytime results keep the query active
+		if (task->Data.bIsFinalResult)
+			ActiveNavigationTaskOwners.Remove(task->Data.Actor.Get());
+
+		task->BroadcastResult();
 
 #if DEBUG_DoNAI_THREADS
-		auto owner = task.Data.Actor.Get();
+		auto owner = task->Data.Actor.Get();
 		UE_LOG(DoNNavigationLog, Display, TEXT("[%s] [game thread] Received new nav result!"), owner ? *owner->GetName() : *FString("Unknown"));
 #endif //DEBUG_DoNAI_THREADS*/
+
+		QueryTaskPool.Release(task);
 	}
 
 	while (!CompletedCollisionTasks.IsEmpty())
@@ -177,12 +183,15 @@ void ADonNavigationManager::ReceiveAsyncResults()
 
 void ADonNavigationManager::ReceiveAsyncDynamicCollisionUpdates()
 {
-	while (!DynamicCollisionBroadcastQueue.IsEmpty())
-	{
-		FDonNavigationVoxel* voxel;
-		DynamicCollisionBroadcastQueue.Dequeue(voxel);
-		voxel->BroadcastCollisionUpdates();
-	}
+	// Everything occupied since the last tick goes out in one batch, one callback per subscribed path
+	TArray<FDonNavigationVoxel*> occupiedVolumes;
+
+	FDonNavigationVoxel* voxel;
+	while (DynamicCollisionBroadcastQueue.Dequeue(voxel))
+		occupiedVolumes.Add(voxel);
+
+	if (occupiedVolumes.Num())
+		BroadcastCollisionUpdates(occupiedVolumes);
 }
 
 void ADonNavigationManager::DrawAsyncDebugRequests()
@@ -224,6 +233,9 @@ void ADonNavigationManager::BeginPlay()
 {
 	Super::BeginPlay();
 
+	if (auto subsystem = UWorld::GetSubsystem<UDonNavigationSubsystem>(GetWorld()))
+		subsystem->RegisterManager(this);
+
 	if (!IgnoreInitOnBeginPlay)
 	{
 		Init();
@@ -255,6 +267,18 @@ void ADonNavigationManager::Init()
 	// Misc:
 	VoxelSizeSquared = VoxelSize * VoxelSize;
 
+	// Agent size layers are tracked as bits per voxel, smallest class first:
+	AgentSizeClasses.RemoveAll([](int32 SizeClass) { return SizeClass < 1 || SizeClass > 32; });
+	AgentSizeClasses.Sort();
+	for (int32 i = AgentSizeClasses.Num() - 1; i > 0; i--)
+		if (AgentSizeClasses[i] == AgentSizeClasses[i - 1])
+			AgentSizeClasses.RemoveAt(i);
+	if (AgentSizeClasses.Num() > 8)
+	{
+		UE_LOG(DoNNavigationLog, Warning, TEXT("Only 8 agent size classes are supported, ignoring the largest %d"), AgentSizeClasses.Num() - 8);
+		AgentSizeClasses.SetNum(8);
+	}
+
 	// Generate the world:
 	ConstructBuilder();
 
@@ -264,7 +288,7 @@ void ADonNavigationManager::Init()
 
 	// Spawn dedicated worker thread:
 	if (bMultiThreadingEnabled)
-		WorkerThread = new FDonNavigationWorker(this, MaxPathSolverIterationsOnThread, MaxCollisionSolverIterationsOnThread);
+		WorkerThread = new FDonNavigationWorker(this, MaxPathSolverIterationsOnThread, MaxCollisionSolverIterationsOnThread, MaxFlowFieldIterationsOnThread, bUsePathSolverTimeBudget ? PathSolverTimeBudgetOnThreadMicroseconds * 1e-6 : 0.0);
 
 	IsInitilized = true;
 }
@@ -283,6 +307,9 @@ void ADonNavigationManager::RefreshPerformanceSettings()
 
 void ADonNavigationManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {	
+	if (auto subsystem = UWorld::GetSubsystem<UDonNavigationSubsystem>(GetWorld()))
+		subsystem->UnregisterManager(this);
+
 	if (WorkerThread)
 	{
 		WorkerThread->ShutDown();
@@ -676,6 +703,8 @@ FDonVoxelCollisionProfile ADonNavigationManager::SampleVoxelCollisionForMesh(UPr
 	FCollisionQueryParams collisionParams = FCollisionQueryParams(FName("GenerateNavigationVolumePixels", bTraceComplex));
 	collisionParams.AddIgnoredActors(ActorsToIgnoreForCollision);
 
+	FDonVoxelOffsetList relativeVoxelOccupancy;
+
 	for (int32 i = xMin; i <= xMax; i++)
 	{
 		for (int32 j = yMin; j <= yMax; j++)
@@ -717,8 +746,7 @@ FDonVoxelCollisionProfile ADonNavigationManager::SampleVoxelCollisionForMesh(UPr
 					if (volumeToCheck == (*meshOriginVolume) && bIgnoreMeshOriginOccupancy)
 						break;
 
-					FVector relativeVoxelOffset = FVector(i - meshOriginVolume->X, j - meshOriginVolume->Y, k - meshOriginVolume->Z);
-					collisionData.RelativeVoxelOccupancy.Add(relativeVoxelOffset);
+					relativeVoxelOccupancy.Add(FDonVoxelOffset(i - meshOriginVolume->X, j - meshOriginVolume->Y, k - meshOriginVolume->Z));
 				}				
 			}
 		}
@@ -727,6 +755,8 @@ FDonVoxelCollisionProfile ADonNavigationManager::SampleVoxelCollisionForMesh(UPr
 	// Make sure we revert the mesh back to its original location:		
 	Mesh->SetWorldLocation(originalMeshLocation, bShouldSweep, NULL, ETeleportType::TeleportPhysics);	
 
+	collisionData.SetOffsets(MoveTemp(relativeVoxelOccupancy));
+
 	return collisionData;
 
 }
@@ -868,7 +898,7 @@ bool ADonNavigationManager::PrepareDynamicCollisionTask(FDonNavigationDynamicCol
 		Task.MeshAssetName = GetMeshAssetName(mesh);
 
 		// Reserve a resonable amount of space for the TArray sampler results:
-		Task.CollisionData.RelativeVoxelOccupancy.Reserve((Task.xLength) * (Task.yLength) * (Task.zLength) / 4);
+		Task.SampledOccupancy.Reserve((Task.xLength) * (Task.yLength) * (Task.zLength) / 4);
 
 		bOverallStatus = true;
 		return true;
@@ -949,8 +979,7 @@ void ADonNavigationManager::TickVoxelCollisionSampler(FDonNavigationDynamicColli
 	{
 		if (overlap.GetComponent() == mesh)
 		{
-			FVector relativeVoxelOffset = FVector(samplerCoordsX - currentMeshOriginVolume->X, samplerCoordsY - currentMeshOriginVolume->Y, samplerCoordsZ - currentMeshOriginVolume->Z);
-			Task.CollisionData.RelativeVoxelOccupancy.Add(relativeVoxelOffset);
+			Task.SampledOccupancy.Add(FDonVoxelOffset(samplerCoordsX - currentMeshOriginVolume->X, samplerCoordsY - currentMeshOriginVolume->Y, samplerCoordsZ - currentMeshOriginVolume->Z));
 
 			break;
 		}
@@ -975,6 +1004,8 @@ void ADonNavigationManager::TickVoxelCollisionSampler(FDonNavigationDynamicColli
 	{
 		Task.FetchSuccess();
 
+		Task.CollisionData.SetOffsets(MoveTemp(Task.SampledOccupancy));
+
 		if(!Task.bDisableCacheUsage)
 			VoxelCollisionProfileCache_WorkerThread.Add(Task.MeshId, Task.CollisionData);	
 
@@ -984,7 +1015,7 @@ void ADonNavigationManager::TickVoxelCollisionSampler(FDonNavigationDynamicColli
 			//DrawDebugVoxel_Safe(GetWorld(), mesh->Bounds.Origin, mesh->Bounds.BoxExtent, FColor::Green, true, 0, 0, 5.f); // Note-: this needs to be original bound origin for moving objects
 
 			// Draw our solution:
-			for (const auto& offset : Task.CollisionData.RelativeVoxelOccupancy)
+			for (const auto& offset : Task.CollisionData.Offsets())
 			{
 				auto& volume = VolumeAtUnsafe(Task.MeshOriginalVolume.X + offset.X, Task.MeshOriginalVolume.Y + offset.Y, Task.MeshOriginalVolume.Z + offset.Z);
 				DrawDebugVoxel_Safe(GetWorld(), volume.Location, NavVolumeExtent(), FColor::Red, false, 0.13f, 0, DebugVoxelsLineThickness);
@@ -1129,26 +1160,37 @@ void ADonNavigationManager::DynamicCollisionUpdateForMesh(const FDonMeshIdentifi
 		return;
 	}
 	
-	// Note: Combining both loops (O(N2)) into a single loop possibly backed by a TSet for quick lookup of WorldVoxelsOccupied may boost performance. Profiling verification necessary.
+	const FDonVoxelOffsetList& voxelOffsets = VoxelCollisionProfile.Offsets();
+	const int32 numVoxels = voxelOffsets.Num();
 
-	const int32 numVoxels = VoxelCollisionProfile.RelativeVoxelOccupancy.Num();
+	// Flush out occupancy from previously occupied voxels. These are re-derived from the voxel the profile was last stamped from
+	// (VolumeAtSafe skips exactly the same out-of-bounds offsets as it did while occupying them)
+	const bool bFreesPreviousSpace = VoxelCollisionProfile.bOccupiesWorld;
+	const FIntVector previousOrigin(VoxelCollisionProfile.WorldOriginX, VoxelCollisionProfile.WorldOriginY, VoxelCollisionProfile.WorldOriginZ);
 
-	// Flush out occupancy from previously occupied voxels:
-	for (auto volume : VoxelCollisionProfile.WorldVoxelsOccupied)
+	if (VoxelCollisionProfile.bOccupiesWorld)
 	{
-		if(volume)
-			volume->SetNavigability(true);
+		InvalidateFlowFieldsForProfile(VoxelCollisionProfile, VoxelCollisionProfile.WorldOriginX, VoxelCollisionProfile.WorldOriginY, VoxelCollisionProfile.WorldOriginZ);
+		InvalidateNearestNavigableVolumesForProfile(VoxelCollisionProfile, VoxelCollisionProfile.WorldOriginX, VoxelCollisionProfile.WorldOriginY, VoxelCollisionProfile.WorldOriginZ);
 
-		// Draw free'd voxels //if (bDrawDebug) DrawDebugVoxel_Safe(GetWorld(), volume->Location, NavVolumeExtent(), FColor::Green, true, 0, 0, DebugVoxelsLineThickness);
-	}	
+		for (const auto& offset : voxelOffsets)
+		{
+			auto volume = VolumeAtSafe(VoxelCollisionProfile.WorldOriginX + offset.X, VoxelCollisionProfile.WorldOriginY + offset.Y, VoxelCollisionProfile.WorldOriginZ + offset.Z);
+			if (volume)
+				volume->SetNavigability(true);
+
+			// Draw free'd voxels //if (bDrawDebug) DrawDebugVoxel_Safe(GetWorld(), volume->Location, NavVolumeExtent(), FColor::Green, true, 0, 0, DebugVoxelsLineThickness);
+		}
+	}
 
-	VoxelCollisionProfile.WorldVoxelsOccupied.Empty(numVoxels);
+	VoxelCollisionProfile.SetWorldOrigin(*meshOriginVolume);
+	InvalidateFlowFieldsForProfile(VoxelCollisionProfile, meshOriginVolume->X, meshOriginVolume->Y, meshOriginVolume->Z);
 
 	TArray<FDonNavigationVoxel*> newSpaceOccupied;
 	newSpaceOccupied.Reserve(numVoxels);	
 
 	// and move onto occupy the newly visited voxels:
-	for (const auto& offset : VoxelCollisionProfile.RelativeVoxelOccupancy)
+	for (const auto& offset : voxelOffsets)
 	{
 		auto volume = VolumeAtSafe(meshOriginVolume->X + offset.X, meshOriginVolume->Y + offset.Y, meshOriginVolume->Z + offset.Z);
 		if (!volume)
@@ -1157,7 +1199,6 @@ void ADonNavigationManager::DynamicCollisionUpdateForMesh(const FDonMeshIdentifi
 		auto bPreviouslyNavigable = volume->CanNavigate();
 
 		volume->SetNavigability(false);
-		VoxelCollisionProfile.WorldVoxelsOccupied.Add(volume);
 
 		// For reasons that I don't yet understand, using bPreviouslyNavigable to optimize the number of delegates we check for doesn't work 100% right.
 		// There are edge cases where it causes us to miss out on valuable dynamic collision udpates that we truly need to listen to. 
@@ -1172,22 +1213,77 @@ void ADonNavigationManager::DynamicCollisionUpdateForMesh(const FDonMeshIdentifi
 			DrawDebugVoxel_Safe(GetWorld(), volume->Location, NavVolumeExtent(), FColor::Red, false, 0.13f, 0, DebugVoxelsLineThickness);
 	}
 
-	// Broadcast dynamic collision updates!
-	if (!bMultiThreadingEnabled)
+	// Clearance and agent size layers are invalidated only once the occupancy they derive from is final, so a lazy computation racing us can't cache the old state:
+	if (bFreesPreviousSpace)
+		InvalidateDerivedOccupancyForProfile(VoxelCollisionProfile, previousOrigin.X, previousOrigin.Y, previousOrigin.Z);
+
+	InvalidateDerivedOccupancyForProfile(VoxelCollisionProfile, meshOriginVolume->X, meshOriginVolume->Y, meshOriginVolume->Z);
+
+	// Cached paths running through the newly occupied space are no longer valid:
+	InvalidatePathCache(newSpaceOccupied);
+	NotifyRetainedSearches(newSpaceOccupied);
+
+	// Broadcast dynamic collision updates! These are batched per tick (see ReceiveAsyncDynamicCollisionUpdates) so that a large obstacle moving
+	// across a path, or several obstacles landing on it in the same frame, alert its listener only once.
+	for (auto volume : newSpaceOccupied)
+		DynamicCollisionBroadcastQueue.Enqueue(volume);
+
+
+	// Update the cache with latest occupany data:
+	if(!bDisableCacheUsage)
+		VoxelCollisionProfileCache_WorkerThread.Add(MeshId, VoxelCollisionProfile);
+}
+
+void ADonNavigationManager::Debug_BenchmarkGridLineOfSight(UPrimitiveComponent* CollisionComponent, int32 NumSegments/* = 1000*/, int32 AgentRadiusVoxels/* = 0*/)
+{
+	if (bIsUnbound || NumSegments <= 0)
+		return;
+
+	// Segments between random voxel centers:
+	TArray<TPair<FVector, FVector>> segments;
+	segments.Reserve(NumSegments);
+
+	for (int32 i = 0; i < NumSegments; i++)
 	{
-		for (auto volume : newSpaceOccupied)
-			volume->BroadcastCollisionUpdates();
+		const FVector start = LocationAtId(FMath::RandRange(0, XGridSize - 1), FMath::RandRange(0, YGridSize - 1), FMath::RandRange(0, ZGridSize - 1));
+		const FVector end = LocationAtId(FMath::RandRange(0, XGridSize - 1), FMath::RandRange(0, YGridSize - 1), FMath::RandRange(0, ZGridSize - 1));
+		segments.Add(TPair<FVector, FVector>(start, end));
 	}
-	else
+
+	TBitArray<> gridResults(false, NumSegments);
+	int32 numClearInGrid = 0;
+
+	double timer = FPlatformTime::Seconds();
+
+	for (int32 i = 0; i < NumSegments; i++)
 	{
-		for (auto volume : newSpaceOccupied)
-			DynamicCollisionBroadcastQueue.Enqueue(volume);
+		gridResults[i] = IsSegmentClearInGrid(segments[i].Key, segments[i].Value, AgentRadiusVoxels);
+		numClearInGrid += gridResults[i] ? 1 : 0;
 	}
-	
 
-	// Update the cache with latest occupany data:
-	if(!bDisableCacheUsage)
-		VoxelCollisionProfileCache_WorkerThread.Add(MeshId, VoxelCollisionProfile);
+	const double gridTime = FPlatformTime::Seconds() - timer;
+
+	UE_LOG(DoNNavigationLog, Display, TEXT("Grid line of sight: %d segments in %f ms (%f us per segment), %d clear"), NumSegments, gridTime * 1000.0, gridTime * 1e6 / NumSegments, numClearInGrid);
+
+	if (!CollisionComponent)
+		return;
+
+	int32 numClearBySweep = 0;
+	int32 numAgreements = 0;
+
+	timer = FPlatformTime::Seconds();
+
+	for (int32 i = 0; i < NumSegments; i++)
+	{
+		FHitResult hit;
+		const bool bClear = IsDirectPathLineSweep(CollisionComponent, segments[i].Key, segments[i].Value, hit, true);
+		numClearBySweep += bClear ? 1 : 0;
+		numAgreements += bClear == gridResults[i] ? 1 : 0;
+	}
+
+	const double sweepTime = FPlatformTime::Seconds() - timer;
+
+	UE_LOG(DoNNavigationLog, Display, TEXT("Physics sweeps: %d segments in %f ms (%f us per segment), %d clear. Results agree for %d segments"), NumSegments, sweepTime * 1000.0, sweepTime * 1e6 / NumSegments, numClearBySweep, numAgreements);
 }
 
 void ADonNavigationManager::Debug_ToggleWorldBoundaryInGame()
@@ -1290,7 +1386,7 @@ void ADonNavigationManager::Debug_DrawVoxelCollisionProfile(UPrimitiveComponent*
 
 	// ~~~
 	// Step 2. Draw all the other voxels (for meshes which are using a full-blown voxel profile representation)
-	for (auto offset : voxelCollisionProfile.RelativeVoxelOccupancy)
+	for (const auto& offset : voxelCollisionProfile.Offsets())
 	{
 		const int32 voxelX = meshOriginVolume->X + offset.X;
 		const int32 voxelY = meshOriginVolume->Y + offset.Y;
@@ -1529,36 +1625,209 @@ static bool PathSolutionFromVolumeTrajectoryMap(FDonNavigationVoxel* OriginVolum
 	
 }
 
-FDonNavigationVoxel* ADonNavigationManager::GetBestNeighborRecursive(FDonNavigationVoxel* Volume, int32 CurrentDepth, int32 NeighborSearchMaxDepth, FVector Location, UPrimitiveComponent* CollisionComponent, bool bConsiderInitialOverlaps, float CollisionShapeInflation, bool bShouldSweep)
+FDonNavigationVoxel* ADonNavigationManager::FindNearestNavigableVolume(FDonNavigationVoxel* Volume, int32 MaxRadius, FVector Location, UPrimitiveComponent* CollisionComponent, bool bConsiderInitialOverlaps, float CollisionShapeInflation, bool bShouldSweep)
 {
-	if (CurrentDepth > NeighborSearchMaxDepth)
-		return NULL;
+	// Breadth-first over the 26-neighborhood, one ring (voxels at the same Chebyshev distance from Volume) per level.
+	// The visited set only needs to cover the cube the rings can reach:
+	const int32 side = 2 * MaxRadius + 1;
+	TBitArray<> visited(false, side * side * side);
 
-	FHitResult hit;
-	const auto& neighbors = FindOrSetupNeighborsForVolume(Volume);
+	auto localIndex = [Volume, MaxRadius, side](const FDonNavigationVoxel* Other)
+	{
+		return (Other->X - Volume->X + MaxRadius) + side * ((Other->Y - Volume->Y + MaxRadius) + side * (Other->Z - Volume->Z + MaxRadius));
+	};
+
+	TArray<FDonNavigationVoxel*> ring, nextRing;
+	ring.Add(Volume);
+	visited[localIndex(Volume)] = true;
 
-	for (auto neighbor : neighbors)
+	TArray<TPair<float, FDonNavigationVoxel*>> candidates;
+	TArray<bool> accessible;
+
+	const int32 batchSize = FMath::Max(NearestNavigableVolumeSweepBatchSize, 1);
+
+	FDonNavigationVoxel* nearest = NULL;
+	float nearestDistSq = TNumericLimits<float>::Max();
+
+	for (int32 radius = 1; radius <= MaxRadius; radius++)
 	{
-		if (!CanNavigate(neighbor))
+		// Location lies inside Volume, so every voxel of this ring is at least (radius - 0.5) voxels away from it. Nothing further out can be nearer:
+		if (nearest && nearestDistSq <= FMath::Square((radius - 0.5f) * VoxelSize))
+			break;
+
+		nextRing.Reset();
+
+		for (auto volume : ring)
+		{
+			for (int32 z = -1; z <= 1; z++)
+			for (int32 y = -1; y <= 1; y++)
+			for (int32 x = -1; x <= 1; x++)
+			{
+				auto neighbor = VolumeAtSafe(volume->X + x, volume->Y + y, volume->Z + z);
+				if (!neighbor)
+					continue;
+
+				const int32 index = localIndex(neighbor);
+				if (visited[index])
+					continue;
+
+				visited[index] = true;
+				nextRing.Add(neighbor);
+			}
+		}
+
+		Swap(ring, nextRing);
+
+		if (!ring.Num())
+			break;
+
+		candidates.Reset();
+
+		for (auto volume : ring)
+		{
+			const float distSq = FVector::DistSquared(Location, volume->Location);
+			if (distSq < nearestDistSq && CanNavigate(volume))
+				candidates.Emplace(distSq, volume);
+		}
+
+		if (!candidates.Num())
 			continue;
 
+		candidates.Sort([](const TPair<float, FDonNavigationVoxel*>& A, const TPair<float, FDonNavigationVoxel*>& B) { return A.Key < B.Key; });
+
 		if (!bShouldSweep)
-			return neighbor;
-		else if (IsDirectPathLineSweep(CollisionComponent, Location, neighbor->Location, hit, bConsiderInitialOverlaps, CollisionShapeInflation))
-			return neighbor;
+		{
+			nearestDistSq = candidates[0].Key;
+			nearest = candidates[0].Value;
+
+			continue;
+		}
+
+		// Sweep for access, nearest candidates first, a batch at a time:
+		for (int32 first = 0; first < candidates.Num(); first += batchSize)
+		{
+			const int32 count = FMath::Min(batchSize, candidates.Num() - first);
+			accessible.SetNumZeroed(count);
+
+			ParallelFor(count, [&](int32 k)
+			{
+				FHitResult hit;
+				accessible[k] = IsDirectPathLineSweep(CollisionComponent, Location, candidates[first + k].Value->Location, hit, bConsiderInitialOverlaps, CollisionShapeInflation);
+			}, count < 2 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+			const int32 accessibleIndex = accessible.Find(true);
+			if (accessibleIndex != INDEX_NONE)
+			{
+				nearestDistSq = candidates[first + accessibleIndex].Key;
+				nearest = candidates[first + accessibleIndex].Value;
+
+				break;
+			}
+		}
+	}
+
+	return nearest;
+}
+
+FDonNavigationVoxel* ADonNavigationManager::FindCachedNearestNavigableVolume(FDonNavigationVoxel* Volume)
+{
+	FScopeLock lock(&NearestNavigableVolumeLock);
+
+	auto entry = NearestNavigableVolumeCache.Find(Volume);
+	if (!entry)
+		return NULL;
+
+	// Most recently used:
+	NearestNavigableVolumeUsage.RemoveNode(entry->UsageNode, false);
+	NearestNavigableVolumeUsage.AddHead(entry->UsageNode);
+
+	return entry->NearestVolume;
+}
+
+void ADonNavigationManager::CacheNearestNavigableVolume(FDonNavigationVoxel* Volume, FDonNavigationVoxel* NearestVolume)
+{
+	// Blocked voxels are only ever resolved around agents and query endpoints, so this stays small in practice. The least recently used make room if it doesn't:
+	static const int32 maxCachedVolumes = 65536;
+
+	FScopeLock lock(&NearestNavigableVolumeLock);
+
+	RemoveCachedNearestNavigableVolume_Locked(Volume);
+
+	if (NearestVolume)
+	{
+		while (NearestNavigableVolumeCache.Num() >= maxCachedVolumes && NearestNavigableVolumeUsage.GetTail())
+			RemoveCachedNearestNavigableVolume_Locked(NearestNavigableVolumeUsage.GetTail()->GetValue());
+
+		FDonNearestNavigableVolumeCacheEntry entry;
+		entry.NearestVolume = NearestVolume;
+		entry.UsageNode = new TDoubleLinkedList<FDonNavigationVoxel*>::TDoubleLinkedListNode(Volume);
+
+		NearestNavigableVolumeUsage.AddHead(entry.UsageNode);
+		NearestNavigableVolumeCache.Add(Volume, entry);
+		NearestNavigableVolumeBuckets.FindOrAdd(NearestNavigableVolumeBucket(Volume->X, Volume->Y, Volume->Z)).Add(Volume);
 	}
 
-	// No suitable volume found, testing neighbors of neighbors:
-	for (auto neighbor : neighbors)
+	NumNearestNavigableVolumesCached.Set(NearestNavigableVolumeCache.Num());
+}
+
+void ADonNavigationManager::RemoveCachedNearestNavigableVolume_Locked(FDonNavigationVoxel* Volume)
+{
+	FDonNearestNavigableVolumeCacheEntry entry;
+	if (!NearestNavigableVolumeCache.RemoveAndCopyValue(Volume, entry))
+		return;
+
+	NearestNavigableVolumeUsage.RemoveNode(entry.UsageNode);
+
+	const FIntVector bucketKey = NearestNavigableVolumeBucket(Volume->X, Volume->Y, Volume->Z);
+	auto bucket = NearestNavigableVolumeBuckets.Find(bucketKey);
+	if (bucket)
 	{
-		// need to optimize redundancy. A large number of voxels will get queried multiple times due to multi-neighbor relationships. Consider maintaining a hash (TSet) of visited neighbors
-		// @Bug - the function below should actually use "neighbor" and not "Volume"! As this needs more testing, the change is reserved for a future update.
-		auto bestVolume = GetBestNeighborRecursive(Volume, CurrentDepth + 1, NeighborSearchMaxDepth, Location, CollisionComponent, bConsiderInitialOverlaps, CollisionShapeInflation, bShouldSweep);
-		if (bestVolume)
-			return bestVolume;
+		bucket->RemoveSingleSwap(Volume, false);
+
+		if (!bucket->Num())
+			NearestNavigableVolumeBuckets.Remove(bucketKey);
 	}
+}
+
+void ADonNavigationManager::InvalidateNearestNavigableVolumesForProfile(const FDonVoxelCollisionProfile& Profile, int32 OriginX, int32 OriginY, int32 OriginZ)
+{
+	// Voxels freed here may now be nearer than the substitute cached for any blocked voxel within search reach of them.
+	// (voxels becoming blocked need no invalidation: every cached substitute is checked for navigability when used)
+	if (!NumNearestNavigableVolumesCached.GetValue())
+		return;
+
+	const int32 reach = NearestNavigableVolumeSearchRadius;
+
+	const int32 minX = FMath::Max(OriginX + Profile.OffsetsMin.X - reach, 0), maxX = FMath::Min(OriginX + Profile.OffsetsMax.X + reach, XGridSize - 1);
+	const int32 minY = FMath::Max(OriginY + Profile.OffsetsMin.Y - reach, 0), maxY = FMath::Min(OriginY + Profile.OffsetsMax.Y + reach, YGridSize - 1);
+	const int32 minZ = FMath::Max(OriginZ + Profile.OffsetsMin.Z - reach, 0), maxZ = FMath::Min(OriginZ + Profile.OffsetsMax.Z + reach, ZGridSize - 1);
+
+	const FIntVector minBucket = NearestNavigableVolumeBucket(minX, minY, minZ);
+	const FIntVector maxBucket = NearestNavigableVolumeBucket(maxX, maxY, maxZ);
+
+	FScopeLock lock(&NearestNavigableVolumeLock);
+
+	TArray<FDonNavigationVoxel*> invalidatedVolumes;
+
+	for (int32 x = minBucket.X; x <= maxBucket.X; x++)
+		for (int32 y = minBucket.Y; y <= maxBucket.Y; y++)
+			for (int32 z = minBucket.Z; z <= maxBucket.Z; z++)
+			{
+				const auto bucket = NearestNavigableVolumeBuckets.Find(FIntVector(x, y, z));
+				if (!bucket)
+					continue;
+
+				for (auto volume : *bucket)
+				{
+					if (volume->X >= minX && volume->X <= maxX && volume->Y >= minY && volume->Y <= maxY && volume->Z >= minZ && volume->Z <= maxZ)
+						invalidatedVolumes.Add(volume);
+				}
+			}
 
-	return NULL;		
+	for (auto volume : invalidatedVolumes)
+		RemoveCachedNearestNavigableVolume_Locked(volume);
+
+	NumNearestNavigableVolumesCached.Set(NearestNavigableVolumeCache.Num());
 }
 
 FDonNavigationVoxel* ADonNavigationManager::GetClosestNavigableVolume(FVector Location, UPrimitiveComponent* CollisionComponent, bool &bInitialPositionCollides, float CollisionShapeInflation/* = 0.f;*/, bool bShouldSweep/* = true*/)
@@ -1585,8 +1854,6 @@ FDonNavigationVoxel* ADonNavigationManager::GetClosestNavigableVolume(FVector Lo
 	// and so we need to find the closest neighboring voxel that has direct access to this location.  The purpose of doing this is to find a _substitute_
 	// for this volume  which is both close and navigable. Only such a substitute can be used an entry-point or exit point for pathfinding.
 
-	FHitResult hit;
-
 	bool bConsiderInitialOverlaps = true; // This is really important to understand.
 
 	//
@@ -1615,34 +1882,22 @@ FDonNavigationVoxel* ADonNavigationManager::GetClosestNavigableVolume(FVector Lo
 			return NULL;
 	}
 
-	// 2 a) First we start with simple heuristics based checks for the closest accessible neighbor:
-	static const int32 neighborGuessList = 9;
-	static const int32 expansionStepSize = 2;
-	static const int32 numIterations = 2;
-
-	const int xGuessList[neighborGuessList] = { 0,  2,  2, -2, -2, -2,  2,  0, -2 };
-	const int yGuessList[neighborGuessList] = { 0,  0,  2,  0, -2,  2, -2,  0, -2 };
-	const int zGuessList[neighborGuessList] = { 1,  1,  1,  1,  1,  1,  1, -1, -1 };
-
-	for (int32 step = 1; step <= numIterations; step++)
+	// Resolved this voxel before? The substitute found then only needs to be confirmed (still navigable and accessible from here):
+	auto cachedVolume = FindCachedNearestNavigableVolume(volume);
+	if (cachedVolume && CanNavigate(cachedVolume))
 	{
-		for (int32 i = 0; i < neighborGuessList; i++)
-		{
-			int32 stepScale = step * expansionStepSize;
-			auto volumeGuess = VolumeAtSafe(volume->X + xGuessList[i], volume->Y + yGuessList[i], volume->Z + zGuessList[i] * stepScale);
-			if (volumeGuess && CanNavigate(volumeGuess))
-			{
-				if (!bShouldSweep)
-					return volumeGuess;
-				else if (IsDirectPathLineSweep(CollisionComponent, Location, volumeGuess->Location, hit, bConsiderInitialOverlaps, CollisionShapeInflation))
-					return volumeGuess;
-			}
-		}
+		if (!bShouldSweep)
+			return cachedVolume;
+
+		FHitResult hit;
+		if (IsDirectPathLineSweep(CollisionComponent, Location, cachedVolume->Location, hit, bConsiderInitialOverlaps, CollisionShapeInflation))
+			return cachedVolume;
 	}
-	
-	// 2 b) So we still haven't found an ideal neighbor. It's time to methodically scan for best neighbors:
-	const int32 neighborSearchMaxDepth = 2;
-	auto result = GetBestNeighborRecursive(volume, 0, neighborSearchMaxDepth, Location, CollisionComponent, bConsiderInitialOverlaps, CollisionShapeInflation, bShouldSweep);	
+
+	// Search outwards ring by ring for the nearest navigable voxel with direct access to this location:
+	auto result = FindNearestNavigableVolume(volume, NearestNavigableVolumeSearchRadius, Location, CollisionComponent, bConsiderInitialOverlaps, CollisionShapeInflation, bShouldSweep);
+
+	CacheNearestNavigableVolume(volume, result);
 
 	if (result)
 		return result;
@@ -1859,12 +2114,16 @@ bool ADonNavigationManager::CanNavigate(FDonNavigationVoxel* Volume)
 
 bool ADonNavigationManager::CanNavigateByCollisionProfile(FDonNavigationVoxel* Volume, const FDonVoxelCollisionProfile& CollisionToTest)
 {	
+	// Large pawns: a single clearance lookup stands in for testing every voxel of the profile
+	if (bUseClearanceField && CollisionToTest.Num() && CollisionToTest.ChebyshevRadius < MaxClearanceVoxels)
+		return GetVoxelClearance(Volume) > CollisionToTest.ChebyshevRadius;
+
 	if (!CanNavigate(Volume))
 		return false;
 
 	bool bCanNavigate = true;
 
-	for (FVector voxelOffset : CollisionToTest.RelativeVoxelOccupancy)
+	for (const FDonVoxelOffset& voxelOffset : CollisionToTest.Offsets())
 	{
 		auto neighborToTest = NeighborAt(Volume, voxelOffset);
 		if (!neighborToTest || !CanNavigate(neighborToTest)) // invalid neighborToTest could indicate collision with world boundary
@@ -1881,7 +2140,7 @@ bool ADonNavigationManager::CanNavigateByCollisionProfile(FVector Location, cons
 
 	bool bCanNavigate = true;
 
-	for (FVector voxelOffset : CollisionToTest.RelativeVoxelOccupancy)
+	for (const FDonVoxelOffset& voxelOffset : CollisionToTest.Offsets())
 	{
 		FVector locationToTest = LocationAtId(Location, voxelOffset.X, voxelOffset.Y, voxelOffset.Z);
 
@@ -1892,99 +2151,444 @@ bool ADonNavigationManager::CanNavigateByCollisionProfile(FVector Location, cons
 	return bCanNavigate;
 }
 
-void ADonNavigationManager::ExpandFrontierTowardsTarget(FDonNavigationQueryTask& Task, FDonNavigationVoxel* Current, FDonNavigationVoxel* Neighbor)
-{	
-	if (!CanNavigateByCollisionProfile(Neighbor, Task.Data.VoxelCollisionProfile))
-		return;
-
-	// In reality there are two possible segment distances: side and sqrt(2) * side. As a trade-off between accuracy and performance we're assuming all segments to be only equal to the pixel size (majority case are 6-DOF neighbors)
-	float SegmentDist = VoxelSize;
-	
-	uint32 newCost = *Task.Data.VolumeVsCostMap.Find(Current) + SegmentDist;
-	uint32* volumeCost = Task.Data.VolumeVsCostMap.Find(Neighbor);
-
-	if (!volumeCost || newCost < *volumeCost)
-	{	
-		Task.Data.VolumeVsGoalTrajectoryMap.Add(Neighbor, Current);
-		Task.Data.VolumeVsCostMap.Add(Neighbor, newCost);
-
-		float heuristic = FVector::Dist(Neighbor->Location, Task.Data.Destination);
-		uint32 priority = newCost + heuristic;
+bool ADonNavigationManager::IsSegmentClearInGrid(FVector Start, FVector End, int32 AgentRadiusVoxels/* = 0*/)
+{
+	if (bIsUnbound)
+	{
+		UE_LOG(DoNNavigationLog, Warning, TEXT("IsSegmentClearInGrid is only available for Finite Worlds"));
 
-		Task.Data.Frontier.put(Neighbor, priority);
+		return false;
 	}
+
+	return ForEachVoxelAlongSegment(Start, End, [this, AgentRadiusVoxels](FDonNavigationVoxel* Volume)
+	{
+		return Volume && IsNavigableForAgentRadius(Volume, AgentRadiusVoxels);
+	});
 }
 
-void ADonNavigationManager::InvalidVolumeErrorLog(FDonNavigationVoxel* OriginVolume, FDonNavigationVoxel* DestinationDestination, FVector Origin, FVector Destination)
+TArray<FVector> ADonNavigationManager::GetVoxelsAlongSegment(FVector Start, FVector End)
 {
-	bool bLogHelpInfo = true;
-	FVector vectorInQuestion;
+	TArray<FVector> locations;
 
-	if (!OriginVolume)
+	if (bIsUnbound)
 	{
-		vectorInQuestion = Origin;
+		UE_LOG(DoNNavigationLog, Warning, TEXT("GetVoxelsAlongSegment is only available for Finite Worlds"));
 
-		UE_LOG(DoNNavigationLog, Error, TEXT("Error: Invalid Origin (%s) passed to navigation path solver"), *Origin.ToString());
+		return locations;
 	}
 
-	if (!DestinationDestination)
+	ForEachVoxelAlongSegment(Start, End, [&locations](FDonNavigationVoxel* Volume)
 	{
-		vectorInQuestion = Destination;
+		if (Volume)
+			locations.Add(Volume->Location);
 
-		UE_LOG(DoNNavigationLog, Error, TEXT("Error: Invalid Destination (%s) passed to navigation path solver"), *Destination.ToString());
-	}
+		return true;
+	});
 
-	// Troubleshooting instructions already logged for this vector? If so, return to avoid swamping logs
-	if (UnresolvableVectors.Contains(vectorInQuestion))
-		bLogHelpInfo = false;
-	else
-		UnresolvableVectors.Add(vectorInQuestion);
-	
-	if (!bLogHelpInfo)
-		return;
+	return locations;
+}
 
-	FString message = FString("Rules for passing vectors to the system:\n");
-	message += FString("----------------------------------------\n");
-	message += FString("1. Origin and Destination points _must_ be in empty space. They cannot be inside any mesh or right on top of a floor with colliders\n");
-	message += FString("--\n");
-	message += FString("2. Characters and Pawns however, are allowed to use their collision component as origin or destination, but the character Mesh itself must _not_ be configured as BlockAll or BlockAllDynamic.\n");
-	message += FString("You can use the default \"Pawn\" collision profile (default) for character meshes as long as you haven't added it to the ObstacleQueryChannels list in your Don Navigation Manager actor\n");
-	message += FString("--\n");
-	message += FString("3. Trigger volumes cannot the same object type as obstacles (don't use WorldStatic/WorldDynamic/etc). The reason for this is that the system uses overlaps instead of sweeps for optimal performance.\n");
-	message += FString("Please create a new trigger object type for all triggers in your map and use that to avoid trigger volumes being from picked up as obstacles.\n");
+bool ADonNavigationManager::IsNavigableForAgentRadius(FDonNavigationVoxel* Volume, int32 Radius)
+{
+	if (!CanNavigate(Volume))
+		return false;
 
-	UE_LOG(DoNNavigationLog, Warning, TEXT("%s"), *message);
-}
+	if (Radius <= 0)
+		return true;
 
-bool ADonNavigationManager::FindPathSolution_StressTesting(AActor* Actor, FVector Destination, TArray<FVector> &PathSolutionRaw, TArray<FVector> &PathSolutionOptimized, UPARAM(ref) const FDoNNavigationQueryParams& QueryParams, UPARAM(ref) const FDoNNavigationDebugParams& DebugParams)
-{	
-	UPrimitiveComponent* CollisionComponent = Actor ? Cast<UPrimitiveComponent>(Actor->GetRootComponent()) : NULL;
+	// A single lookup while the clearance field covers the radius, shell by shell beyond it:
+	if (Radius < FMath::Clamp(MaxClearanceVoxels, 1, 32))
+		return GetVoxelClearance(Volume) > Radius;
 
-	// Input Validations - I
-	if (!Actor || !CollisionComponent)
+	for (int32 radius = 1; radius <= Radius; radius++)
 	{
-		FString actorLog = Actor ? *Actor->GetName() : *FString("Invalid");
-		FString collisionComponentLog = CollisionComponent ? *CollisionComponent->GetName() : *FString("Invalid");
-		UE_LOG(DoNNavigationLog, Error, TEXT("%s"), *FString::Printf(TEXT("Invalid input parameters received. Actor: %s CollisionComponent: %s"), *actorLog, *collisionComponentLog));
-
-		return false;
+		if (!IsClearanceShellNavigable(Volume, radius))
+			return false;
 	}
 
-	FVector Origin = Actor->GetActorLocation();
+	return true;
+}
 
-	// Do we have direct access to the goal?
-	FHitResult hitResult;
-	const bool bFindInitialOverlaps = true;
-	if (IsDirectPathLineSweep(CollisionComponent, Origin, Destination, hitResult, bFindInitialOverlaps))
-	{
-		PathSolutionRaw.Add(Origin);
-		PathSolutionRaw.Add(Destination);
-		PathSolutionOptimized = PathSolutionRaw;
+int32 ADonNavigationManager::GetClearanceAtLocation(FVector Location)
+{
+	auto volume = VolumeAt(Location);
 
-		VisualizeSolution(Origin, Destination, PathSolutionRaw, PathSolutionOptimized, DebugParams);
+	return volume ? GetVoxelClearance(volume) : -1;
+}
 
-		return true;
-	}
+uint8 ADonNavigationManager::GetVoxelClearance(FDonNavigationVoxel* Volume)
+{
+	if (Volume->Clearance != FDonNavigationVoxel::ClearanceUnknown)
+		return Volume->Clearance;
+
+	const int32 generation = DerivedOccupancyGeneration.GetValue();
+	const int32 maxClearance = FMath::Clamp(MaxClearanceVoxels, 1, 32);
+	int32 clearance = 0;
+
+	if (CanNavigate(Volume))
+	{
+		// Clearance changes by at most one between adjacent voxels, so any neighbor we already know about tells us how many shells are guaranteed to be free:
+		int32 firstShellToTest = 1;
+
+		for (int32 i = 0; i < Volume6DOF; i++)
+		{
+			auto neighbor = VolumeAtSafe(Volume->X + x6DOFCoords[i], Volume->Y + y6DOFCoords[i], Volume->Z + z6DOFCoords[i]);
+			if (neighbor && neighbor->Clearance != FDonNavigationVoxel::ClearanceUnknown)
+				firstShellToTest = FMath::Max(firstShellToTest, neighbor->Clearance - 1);
+		}
+
+		clearance = maxClearance;
+
+		for (int32 radius = firstShellToTest; radius < maxClearance; radius++)
+		{
+			if (!IsClearanceShellNavigable(Volume, radius))
+			{
+				clearance = radius;
+				break;
+			}
+		}
+	}
+
+	Volume->Clearance = (uint8)clearance;
+	bHasDerivedOccupancyData = true;
+
+	// An invalidation ran while we were computing: the value may be based on stale occupancy (and may have been stored after the invalidation cleared it)
+	FPlatformMisc::MemoryBarrier();
+	if (DerivedOccupancyGeneration.GetValue() != generation)
+		Volume->Clearance = FDonNavigationVoxel::ClearanceUnknown;
+
+	return (uint8)clearance;
+}
+
+bool ADonNavigationManager::IsClearanceShellNavigable(FDonNavigationVoxel* Volume, int32 Radius)
+{
+	for (int32 x = -Radius; x <= Radius; x++)
+	{
+		for (int32 y = -Radius; y <= Radius; y++)
+		{
+			// Only the surface of the cube belongs to this shell, the interior was covered by smaller radii:
+			const bool bOnShellXY = FMath::Abs(x) == Radius || FMath::Abs(y) == Radius;
+			const int32 zStep = bOnShellXY ? 1 : 2 * Radius;
+
+			for (int32 z = -Radius; z <= Radius; z += zStep)
+			{
+				auto volume = VolumeAtSafe(Volume->X + x, Volume->Y + y, Volume->Z + z);
+				if (!volume || !CanNavigate(volume)) // the world boundary counts as an obstacle
+					return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+int32 ADonNavigationManager::SelectAgentSizeLayer(const FDonVoxelCollisionProfile& CollisionProfile) const
+{
+	// Pawns that fit within a single voxel are already tested with a single lookup
+	if (bIsUnbound || !CollisionProfile.Num() || !CollisionProfile.ChebyshevRadius)
+		return INDEX_NONE;
+
+	// Classes are sorted at Init, so the first one that covers the profile is also the closest:
+	for (int32 layer = 0; layer < AgentSizeClasses.Num(); layer++)
+	{
+		if (AgentSizeClasses[layer] >= CollisionProfile.ChebyshevRadius)
+			return layer;
+	}
+
+	return INDEX_NONE;
+}
+
+bool ADonNavigationManager::IsNavigableInLayer(FDonNavigationVoxel* Volume, int32 Layer)
+{
+	const uint8 layerBit = 1 << Layer;
+
+	if (Volume->LayerKnownMask & layerBit)
+		return (Volume->LayerNavigableMask & layerBit) != 0;
+
+	const int32 generation = DerivedOccupancyGeneration.GetValue();
+
+	// Dilating the base occupancy by a radius R is the same as requiring the nearest obstacle to be further than R voxels away. 
+	// Find the first blocked shell (up to the largest class) and resolve every layer at once from it:
+	const int32 largestClass = AgentSizeClasses.Last();
+	int32 firstBlockedShell = largestClass + 1;
+
+	if (!CanNavigate(Volume))
+		firstBlockedShell = 0;
+	else if (Volume->Clearance != FDonNavigationVoxel::ClearanceUnknown && (Volume->Clearance < MaxClearanceVoxels || Volume->Clearance > largestClass))
+		firstBlockedShell = FMath::Min((int32)Volume->Clearance, largestClass + 1);
+	else
+	{
+		for (int32 radius = 1; radius <= largestClass; radius++)
+		{
+			if (!IsClearanceShellNavigable(Volume, radius))
+			{
+				firstBlockedShell = radius;
+				break;
+			}
+		}
+	}
+
+	uint8 navigableMask = 0;
+
+	for (int32 layer = 0; layer < AgentSizeClasses.Num(); layer++)
+	{
+		if (AgentSizeClasses[layer] < firstBlockedShell)
+			navigableMask |= 1 << layer;
+	}
+
+	Volume->LayerNavigableMask = navigableMask;
+	FPlatformMisc::MemoryBarrier(); // the known bits must never be seen ahead of the navigable bits they vouch for
+	Volume->LayerKnownMask = (1 << AgentSizeClasses.Num()) - 1;
+	bHasDerivedOccupancyData = true;
+
+	// Same as GetVoxelClearance: an invalidation ran while we were computing, so forget what we just stored
+	FPlatformMisc::MemoryBarrier();
+	if (DerivedOccupancyGeneration.GetValue() != generation)
+		Volume->LayerKnownMask = 0;
+
+	return (navigableMask & layerBit) != 0;
+}
+
+int32 ADonNavigationManager::AgentReachInVoxels(const FDonVoxelCollisionProfile& VoxelCollisionProfile, int32 AgentSizeLayer) const
+{
+	return AgentSizeLayer != INDEX_NONE ? AgentSizeClasses[AgentSizeLayer] : VoxelCollisionProfile.ChebyshevRadius;
+}
+
+bool ADonNavigationManager::CanNavigateForQuery(FDonNavigationVoxel* Volume, const FDoNNavigationQueryData& QueryData)
+{
+	return CanNavigateForAgent(Volume, QueryData.VoxelCollisionProfile, QueryData.AgentSizeLayer);
+}
+
+bool ADonNavigationManager::CanNavigateForAgent(FDonNavigationVoxel* Volume, const FDonVoxelCollisionProfile& VoxelCollisionProfile, int32 AgentSizeLayer)
+{
+	if (AgentSizeLayer != INDEX_NONE)
+		return IsNavigableInLayer(Volume, AgentSizeLayer);
+
+	return CanNavigateByCollisionProfile(Volume, VoxelCollisionProfile);
+}
+
+void ADonNavigationManager::InvalidateDerivedOccupancy(int32 MinX, int32 MinY, int32 MinZ, int32 MaxX, int32 MaxY, int32 MaxZ)
+{
+	// The occupancy change being invalidated must be visible before any lazy computation can start over (see GetVoxelClearance)
+	FPlatformMisc::MemoryBarrier();
+
+	if (!bHasDerivedOccupancyData)
+		return;
+
+	DerivedOccupancyGeneration.Increment();
+
+	// A change in occupancy only affects clearance values and layers within reach of the largest tracked radius
+	const int32 reach = FMath::Max(FMath::Clamp(MaxClearanceVoxels, 1, 32), AgentSizeClasses.Num() ? AgentSizeClasses.Last() : 0);
+
+	MinX = FMath::Max(MinX - reach, 0);
+	MinY = FMath::Max(MinY - reach, 0);
+	MinZ = FMath::Max(MinZ - reach, 0);
+	MaxX = FMath::Min(MaxX + reach, XGridSize - 1);
+	MaxY = FMath::Min(MaxY + reach, YGridSize - 1);
+	MaxZ = FMath::Min(MaxZ + reach, ZGridSize - 1);
+
+	for (int32 x = MinX; x <= MaxX; x++)
+		for (int32 y = MinY; y <= MaxY; y++)
+			for (int32 z = MinZ; z <= MaxZ; z++)
+			{
+				if (!IsValidVolume(x, y, z))
+					continue;
+
+				auto& volume = VolumeAtUnsafe(x, y, z);
+				volume.Clearance = FDonNavigationVoxel::ClearanceUnknown;
+				volume.LayerKnownMask = 0;
+			}
+}
+
+void ADonNavigationManager::InvalidateDerivedOccupancyForProfile(const FDonVoxelCollisionProfile& Profile, int32 OriginX, int32 OriginY, int32 OriginZ)
+{
+	InvalidateDerivedOccupancy(OriginX + Profile.OffsetsMin.X, OriginY + Profile.OffsetsMin.Y, OriginZ + Profile.OffsetsMin.Z,
+						OriginX + Profile.OffsetsMax.X, OriginY + Profile.OffsetsMax.Y, OriginZ + Profile.OffsetsMax.Z);
+}
+
+void ADonNavigationManager::ExpandFrontierTowardsTarget(FDonNavigationQueryTask& Task, FDonNavigationVoxel* Current, FDonNavigationVoxel* Neighbor)
+{	
+	if (!CanNavigateForQuery(Neighbor, Task.Data))
+		return;
+
+	if (Task.Data.IsOutsideSearchCorridor(Neighbor->Location))
+	{
+		Task.Data.SearchCorridorBoundary.Add(Current);
+		return;
+	}
+
+	if (Task.Data.UsesLazyThetaStar())
+	{
+		ExpandFrontierAnyAngle(Task, Current, Neighbor);
+		return;
+	}
+
+	// In reality there are two possible segment distances: side and sqrt(2) * side. As a trade-off between accuracy and performance we're assuming all segments to be only equal to the pixel size (majority case are 6-DOF neighbors)
+	float SegmentDist = VoxelSize;
+	
+	uint32 newCost = *Task.Data.VolumeVsCostMap.Find(Current) + SegmentDist;
+	uint32* volumeCost = Task.Data.VolumeVsCostMap.Find(Neighbor);
+
+	if (!volumeCost || newCost < *volumeCost)
+	{	
+		Task.Data.VolumeVsGoalTrajectoryMap.Add(Neighbor, Current);
+		Task.Data.VolumeVsCostMap.Add(Neighbor, newCost);
+
+		// Anytime queries: a closed volume whose cost improved is revisited only in the next refinement pass
+		if (Task.Data.HeuristicWeight > 1.f && Task.Data.AnytimeClosedVolumes.Contains(Neighbor))
+		{
+			Task.Data.AnytimeInconsistentVolumes.Add(Neighbor);
+			return;
+		}
+
+		float heuristic = FVector::Dist(Neighbor->Location, Task.Data.Destination);
+		uint32 priority = newCost + heuristic * Task.Data.HeuristicWeight;
+
+		Task.Data.Frontier.put(Neighbor, priority);
+	}
+}
+
+// Lazy Theta*: the neighbor is assumed visible from the current volume's parent and linked straight to it. The link is only verified
+// once the neighbor is taken off the frontier (see UpdateAnyAngleParent), which saves a line of sight check for every volume that never is.
+void ADonNavigationManager::ExpandFrontierAnyAngle(FDonNavigationQueryTask& Task, FDonNavigationVoxel* Current, FDonNavigationVoxel* Neighbor)
+{
+	auto& data = Task.Data;
+
+	if (data.LazyThetaClosedVolumes.Contains(Neighbor))
+		return;
+
+	FDonNavigationVoxel** currentParent = data.VolumeVsGoalTrajectoryMap.Find(Current);
+	FDonNavigationVoxel* parent = currentParent ? *currentParent : Current; // the origin has no parent
+
+	const uint32 newCost = data.VolumeVsCostMap.FindChecked(parent) + (uint32)FVector::Dist(parent->Location, Neighbor->Location);
+	uint32* volumeCost = data.VolumeVsCostMap.Find(Neighbor);
+
+	if (!volumeCost || newCost < *volumeCost)
+	{
+		data.VolumeVsGoalTrajectoryMap.Add(Neighbor, parent);
+		data.VolumeVsCostMap.Add(Neighbor, newCost);
+
+		float heuristic = FVector::Dist(Neighbor->Location, data.Destination);
+		uint32 priority = newCost + heuristic;
+
+		data.Frontier.put(Neighbor, priority);
+	}
+}
+
+void ADonNavigationManager::UpdateAnyAngleParent(FDonNavigationQueryTask& Task, FDonNavigationVoxel* Volume)
+{
+	auto& data = Task.Data;
+
+	FDonNavigationVoxel** parent = data.VolumeVsGoalTrajectoryMap.Find(Volume);
+	if (!parent || IsGridLineOfSightClearForQuery(*parent, Volume, data))
+		return;
+
+	// No line of sight after all: link to the cheapest settled neighbor instead, exactly as A* would have
+	FDonNavigationVoxel* bestParent = NULL;
+	uint32 bestCost = MAX_uint32;
+
+	for (auto neighbor : FindOrSetupNeighborsForVolume(Volume))
+	{
+		if (!data.LazyThetaClosedVolumes.Contains(neighbor))
+			continue;
+
+		const uint32* cost = data.VolumeVsCostMap.Find(neighbor);
+		if (!cost)
+			continue;
+
+		const uint32 candidateCost = *cost + (uint32)FVector::Dist(neighbor->Location, Volume->Location);
+		if (candidateCost < bestCost)
+		{
+			bestCost = candidateCost;
+			bestParent = neighbor;
+		}
+	}
+
+	if (!bestParent)
+		return;
+
+	data.VolumeVsGoalTrajectoryMap.Add(Volume, bestParent);
+	data.VolumeVsCostMap.Add(Volume, bestCost);
+}
+
+bool ADonNavigationManager::IsGridLineOfSightClearForQuery(FDonNavigationVoxel* From, FDonNavigationVoxel* To, const FDoNNavigationQueryData& QueryData)
+{
+	return ForEachVoxelAlongSegment(From->Location, To->Location, [this, &QueryData](FDonNavigationVoxel* Volume)
+	{
+		return Volume && CanNavigateForQuery(Volume, QueryData);
+	});
+}
+
+void ADonNavigationManager::InvalidVolumeErrorLog(FDonNavigationVoxel* OriginVolume, FDonNavigationVoxel* DestinationDestination, FVector Origin, FVector Destination)
+{
+	bool bLogHelpInfo = true;
+	FVector vectorInQuestion;
+
+	if (!OriginVolume)
+	{
+		vectorInQuestion = Origin;
+
+		UE_LOG(DoNNavigationLog, Error, TEXT("Error: Invalid Origin (%s) passed to navigation path solver"), *Origin.ToString());
+	}
+
+	if (!DestinationDestination)
+	{
+		vectorInQuestion = Destination;
+
+		UE_LOG(DoNNavigationLog, Error, TEXT("Error: Invalid Destination (%s) passed to navigation path solver"), *Destination.ToString());
+	}
+
+	// Troubleshooting instructions already logged for this vector? If so, return to avoid swamping logs
+	if (UnresolvableVectors.Contains(vectorInQuestion))
+		bLogHelpInfo = false;
+	else
+		UnresolvableVectors.Add(vectorInQuestion);
+	
+	if (!bLogHelpInfo)
+		return;
+
+	FString message = FString("Rules for passing vectors to the system:\n");
+	message += FString("----------------------------------------\n");
+	message += FString("1. Origin and Destination points _must_ be in empty space. They cannot be inside any mesh or right on top of a floor with colliders\n");
+	message += FString("--\n");
+	message += FString("2. Characters and Pawns however, are allowed to use their collision component as origin or destination, but the character Mesh itself must _not_ be configured as BlockAll or BlockAllDynamic.\n");
+	message += FString("You can use the default \"Pawn\" collision profile (default) for character meshes as long as you haven't added it to the ObstacleQueryChannels list in your Don Navigation Manager actor\n");
+	message += FString("--\n");
+	message += FString("3. Trigger volumes cannot the same object type as obstacles (don't use WorldStatic/WorldDynamic/etc). The reason for this is that the system uses overlaps instead of sweeps for optimal performance.\n");
+	message += FString("Please create a new trigger object type for all triggers in your map and use that to avoid trigger volumes being from picked up as obstacles.\n");
+
+	UE_LOG(DoNNavigationLog, Warning, TEXT("%s"), *message);
+}
+
+bool ADonNavigationManager::FindPathSolution_StressTesting(AActor* Actor, FVector Destination, TArray<FVector> &PathSolutionRaw, TArray<FVector> &PathSolutionOptimized, UPARAM(ref) const FDoNNavigationQueryParams& QueryParams, UPARAM(ref) const FDoNNavigationDebugParams& DebugParams)
+{	
+	UPrimitiveComponent* CollisionComponent = Actor ? Cast<UPrimitiveComponent>(Actor->GetRootComponent()) : NULL;
+
+	// Input Validations - I
+	if (!Actor || !CollisionComponent)
+	{
+		FString actorLog = Actor ? *Actor->GetName() : *FString("Invalid");
+		FString collisionComponentLog = CollisionComponent ? *CollisionComponent->GetName() : *FString("Invalid");
+		UE_LOG(DoNNavigationLog, Error, TEXT("%s"), *FString::Printf(TEXT("Invalid input parameters received. Actor: %s CollisionComponent: %s"), *actorLog, *collisionComponentLog));
+
+		return false;
+	}
+
+	FVector Origin = Actor->GetActorLocation();
+
+	// Do we have direct access to the goal?
+	FHitResult hitResult;
+	const bool bFindInitialOverlaps = true;
+	if (IsDirectPathLineSweep(CollisionComponent, Origin, Destination, hitResult, bFindInitialOverlaps))
+	{
+		PathSolutionRaw.Add(Origin);
+		PathSolutionRaw.Add(Destination);
+		PathSolutionOptimized = PathSolutionRaw;
+
+		VisualizeSolution(Origin, Destination, PathSolutionRaw, PathSolutionOptimized, DebugParams);
+
+		return true;
+	}
 
 	// Input Visualization - I
 	if (DebugParams.DrawDebugVolumes)
@@ -2062,6 +2666,7 @@ bool ADonNavigationManager::FindPathSolution_StressTesting(AActor* Actor, FVecto
 	);
 
 	auto& data = synchronousTask.Data;
+	data.AgentSizeLayer = SelectAgentSizeLayer(voxelCollisionProfile);
 	float timeSpend = 0;
 	// Core pathfinding algorithm
 	while (!data.bGoalFound && timeSpend <= QueryParams.QueryTimeout)
@@ -2098,11 +2703,18 @@ bool ADonNavigationManager::FindPathSolution_StressTesting(AActor* Actor, FVecto
 	UE_LOG(DoNNavigationLog, Log, TEXT("%s"), *calcTime1);
 
 	// Optimize solution:
-	uint64 timerOptimizationPass = DoNNavigation::Debug_GetTimer();
-	OptimizePathSolution(CollisionComponent, PathSolutionRaw, PathSolutionOptimized, QueryParams.CollisionShapeInflation);
-	DoNNavigation::Debug_StopTimer(timerOptimizationPass);
-	FString calcTime3 = FString::Printf(TEXT("Time spent optimizing path solution - %f seconds"), timerOptimizationPass / 1000.0);
-	UE_LOG(DoNNavigationLog, Log, TEXT("%s"), *calcTime3);
+	if (data.UsesLazyThetaStar() && !bIsUnbound && !QueryParams.bOptimizeAnyAnglePath)
+	{
+		PathSolutionOptimized = PathSolutionRaw;
+	}
+	else
+	{
+		uint64 timerOptimizationPass = DoNNavigation::Debug_GetTimer();
+		OptimizePathSolution(CollisionComponent, PathSolutionRaw, PathSolutionOptimized, QueryParams.CollisionShapeInflation);
+		DoNNavigation::Debug_StopTimer(timerOptimizationPass);
+		FString calcTime3 = FString::Printf(TEXT("Time spent optimizing path solution - %f seconds"), timerOptimizationPass / 1000.0);
+		UE_LOG(DoNNavigationLog, Log, TEXT("%s"), *calcTime3);
+	}
 
 	// Visualize solution:
 	VisualizeSolution(Origin, Destination, PathSolutionRaw, PathSolutionOptimized, DebugParams);
@@ -2110,6 +2722,37 @@ bool ADonNavigationManager::FindPathSolution_StressTesting(AActor* Actor, FVecto
 	return true;
 }
 
+void ADonNavigationManager::Debug_CompareSolverModes(AActor* Actor, FVector Destination, UPARAM(ref) const FDoNNavigationQueryParams& QueryParams)
+{
+	const EDonNavigationSolverMode solverModes[] = { EDonNavigationSolverMode::AStar, EDonNavigationSolverMode::LazyThetaStar };
+	const TCHAR* solverModeNames[] = { TEXT("A* + optimizer"), TEXT("Lazy Theta*") };
+
+	for (int32 i = 0; i < UE_ARRAY_COUNT(solverModes); i++)
+	{
+		FDoNNavigationQueryParams queryParams = QueryParams;
+		queryParams.SolverMode = solverModes[i];
+
+		TArray<FVector> pathSolutionRaw;
+		TArray<FVector> pathSolutionOptimized;
+
+		const double startTime = FPlatformTime::Seconds();
+		const bool bSolved = FindPathSolution_StressTesting(Actor, Destination, pathSolutionRaw, pathSolutionOptimized, queryParams, FDoNNavigationDebugParams());
+		const double timeTaken = FPlatformTime::Seconds() - startTime;
+
+		if (!bSolved)
+		{
+			UE_LOG(DoNNavigationLog, Display, TEXT("%s: no path found (%f ms)"), solverModeNames[i], timeTaken * 1000.0);
+			continue;
+		}
+
+		float pathLength = 0.f;
+		for (int32 j = 1; j < pathSolutionOptimized.Num(); j++)
+			pathLength += FVector::Dist(pathSolutionOptimized[j - 1], pathSolutionOptimized[j]);
+
+		UE_LOG(DoNNavigationLog, Display, TEXT("%s: final path in %f ms, length %f with %d points"), solverModeNames[i], timeTaken * 1000.0, pathLength, pathSolutionOptimized.Num());
+	}
+}
+
 bool ADonNavigationManager::SchedulePathfindingTask(AActor* Actor, FVector Destination, UPARAM(ref) const FDoNNavigationQueryParams& QueryParams, UPARAM(ref) const FDoNNavigationDebugParams& DebugParams, FDoNNavigationResultHandler ResultHandlerDelegate, FDonNavigationDynamicCollisionDelegate DynamicCollisionListener)
 {
 	UPrimitiveComponent* CollisionComponent = Actor ? Cast<UPrimitiveComponent>(Actor->GetRootComponent()) : NULL;
@@ -2161,7 +2804,7 @@ bool ADonNavigationManager::SchedulePathfindingTask(AActor* Actor, FVector Desti
 
 		// call success delegate immediately
 		task.Data.QueryStatus = EDonNavigationQueryStatus::Success;
-		task.ResultHandler.ExecuteIfBound(task.Data);		
+		task.BroadcastResult();
 
 		UE_LOG(DoNNavigationLog, Verbose, TEXT("Query for %s, %s solved via simple direct pathing"), *task.Data.GetActorName(), *task.Data.Destination.ToString(), task.Data.SolverTimeTaken);
 
@@ -2234,6 +2877,7 @@ bool ADonNavigationManager::SchedulePathfindingTask(AActor* Actor, FVector Desti
 		);
 
 	request.Data.QueryStatus = EDonNavigationQueryStatus::InProgress;
+	request.Data.AgentSizeLayer = SelectAgentSizeLayer(voxelCollisionProfile);
 
 	// Schedule this task
 	AddPathfindingTask(request);
@@ -2290,7 +2934,7 @@ bool ADonNavigationManager::SchedulePathfindingTaskFromOrigin(AActor* Actor, FVe
 
 		// call success delegate immediately
 		task.Data.QueryStatus = EDonNavigationQueryStatus::Success;
-		task.ResultHandler.ExecuteIfBound(task.Data);
+		task.BroadcastResult();
 
 		UE_LOG(DoNNavigationLog, Verbose, TEXT("Query for %s, %s solved via simple direct pathing"), *task.Data.GetActorName(), *task.Data.Destination.ToString(), task.Data.SolverTimeTaken);
 
@@ -2363,6 +3007,7 @@ bool ADonNavigationManager::SchedulePathfindingTaskFromOrigin(AActor* Actor, FVe
 	);
 
 	request.Data.QueryStatus = EDonNavigationQueryStatus::InProgress;
+	request.Data.AgentSizeLayer = SelectAgentSizeLayer(voxelCollisionProfile);
 
 	// Schedule this task
 	AddPathfindingTask(request);
@@ -2370,18 +3015,47 @@ bool ADonNavigationManager::SchedulePathfindingTaskFromOrigin(AActor* Actor, FVe
 	return true;
 }
 
-void ADonNavigationManager::AddPathfindingTask(const FDonNavigationQueryTask& Task)
+FDonNavigationQueryTask* FDonNavigationQueryTaskPool::Acquire()
 {
-	if (!bMultiThreadingEnabled)
-	{
-		ActiveNavigationTasks.Add(Task);
-	}
-	else
-	{
+	FDonNavigationQueryTask* task = FreeTasks.Pop();
+	if (task)
+		return task;
+
+	// Pool exhausted, grow the slab:
+	FScopeLock lock(&SlabLock);
+
+	return Slab.Add_GetRef(MakeUnique<FDonNavigationQueryTask>()).Get();
+}
+
+void FDonNavigationQueryTaskPool::Release(FDonNavigationQueryTask* Task)
+{
+	if (!Task)
+		return;
+
+	// Drop the search state and delegate bindings now rather than when the task is next reused
+	*Task = FDonNavigationQueryTask();
+
+	FreeTasks.Push(Task);
+}
+
+void ADonNavigationManager::AddPathfindingTask(const FDonNavigationQueryTask& Task)
+{
+	if (Task.Data.QueryParams.bRetainSearchForRepair && !bIsUnbound)
+		RetainedSearchDestinations.Add(Task.Data.Actor.Get(), Task.Data.Destination);
+
+	auto pooledTask = QueryTaskPool.Acquire();
+	*pooledTask = Task;
+
+	if (!bMultiThreadingEnabled)
+	{
+		ActiveNavigationTasks.Add(pooledTask);
+	}
+	else
+	{
 		auto owner = Task.Data.Actor.Get();
 		ensure(owner);
 		ActiveNavigationTaskOwners.Add(owner);
-	    NewNavigationTasks.Enqueue(Task);
+	    NewNavigationTasks.Enqueue(pooledTask);
 
 #if DEBUG_DoNAI_THREADS
 		UE_LOG(DoNNavigationLog, Display, TEXT("[%s] [game thread] Enqueued new nav task"), owner ? *owner->GetName() : *FString("Unknown"));
@@ -2391,31 +3065,37 @@ void ADonNavigationManager::AddPathfindingTask(const FDonNavigationQueryTask& Ta
 
 void ADonNavigationManager::ReceiveAsyncNavigationTasks()
 {
-	if (NewNavigationTasks.IsEmpty())
-		return;
-
-	FDonNavigationQueryTask newlyArrivedTask;
-	bool bHasNewTask = NewNavigationTasks.Dequeue(newlyArrivedTask);
+	// Drain every request available in one batch. Requests are processed in the order they were sent, so a new task followed by its abort stays consistent
+	FDonNavigationQueryTask* newlyArrivedTask;
 
-	if (bHasNewTask)
+	while (NewNavigationTasks.Dequeue(newlyArrivedTask))
 	{
-		if (newlyArrivedTask.RequestType == EDonNavigationRequestType::New)
+		if (newlyArrivedTask->RequestType == EDonNavigationRequestType::New)
 		{
 			ActiveNavigationTasks.Add(newlyArrivedTask);
 
 #if DEBUG_DoNAI_THREADS
-			auto owner = newlyArrivedTask.Data.Actor.Get();
+			auto owner = newlyArrivedTask->Data.Actor.Get();
 			UE_LOG(DoNNavigationLog, Display, TEXT("[%s] [async thread] Received new nav task"), owner ? *owner->GetName() : *FString("Unknown"));
 #endif //DEBUG_DoNAI_THREADS*/
+
+			continue;
 		}
-		else if (newlyArrivedTask.RequestType == EDonNavigationRequestType::Abort)
+		else if (newlyArrivedTask->RequestType == EDonNavigationRequestType::Abort)
 		{
-			AbortPathfindingTask_Internal(newlyArrivedTask.Data.Actor.Get());
+			AbortPathfindingTask_Internal(newlyArrivedTask->Data.Actor.Get());
 
 #if DEBUG_DoNAI_THREADS
-			UE_LOG(DoNNavigationLog, Display, TEXT("[%s] [async thread] Received new abort request"), actor ? *actor->GetName() : *FString("Unknown"));
+			auto owner = newlyArrivedTask->Data.Actor.Get();
+			UE_LOG(DoNNavigationLog, Display, TEXT("[%s] [async thread] Received new abort request"), owner ? *owner->GetName() : *FString("Unknown"));
 #endif //DEBUG_DoNAI_THREADS*/
 		}
+		else if (newlyArrivedTask->RequestType == EDonNavigationRequestType::ReleaseRetainedSearch)
+		{
+			ReleaseRetainedSearch_Internal(newlyArrivedTask->Data.Actor.Get());
+		}
+
+		QueryTaskPool.Release(newlyArrivedTask);
 	}
 }
 
@@ -2453,7 +3133,8 @@ void ADonNavigationManager::AbortPathfindingTask(AActor* Actor)
 	{
 		ActiveNavigationTaskOwners.Remove(Actor);
 		//NewNavigationAborts.Enqueue(Actor);
-		FDonNavigationQueryTask abortTask(Actor, EDonNavigationRequestType::Abort);
+		auto abortTask = QueryTaskPool.Acquire();
+		*abortTask = FDonNavigationQueryTask(Actor, EDonNavigationRequestType::Abort);
 		NewNavigationTasks.Enqueue(abortTask);
 
 #if DEBUG_DoNAI_THREADS
@@ -2483,11 +3164,41 @@ void ADonNavigationManager::ReceiveAsyncAbortRequests()
 }
 #endif
 
+bool ADonNavigationManager::RepairPathfindingTask(AActor* Actor, UPARAM(ref) const FDoNNavigationQueryParams& QueryParams, UPARAM(ref) const FDoNNavigationDebugParams& DebugParams, FDoNNavigationResultHandler ResultHandlerDelegate, FDonNavigationDynamicCollisionDelegate DynamicCollisionListener)
+{
+	const FVector* destination = RetainedSearchDestinations.Find(Actor);
+	if (!destination)
+		return false;
+
+	FDoNNavigationQueryParams repairParams = QueryParams;
+	repairParams.bRetainSearchForRepair = true;
+	repairParams.bForceRescheduleQuery = true;
+
+	return SchedulePathfindingTask(Actor, *destination, repairParams, DebugParams, ResultHandlerDelegate, DynamicCollisionListener);
+}
+
+void ADonNavigationManager::ReleaseRetainedSearch(AActor* Actor)
+{
+	if (!RetainedSearchDestinations.Remove(Actor))
+		return; // no-op, also keeps superfluous requests out of the task queue
+
+	if (!bMultiThreadingEnabled)
+	{
+		ReleaseRetainedSearch_Internal(Actor);
+	}
+	else
+	{
+		auto releaseTask = QueryTaskPool.Acquire();
+		*releaseTask = FDonNavigationQueryTask(Actor, EDonNavigationRequestType::ReleaseRetainedSearch);
+		NewNavigationTasks.Enqueue(releaseTask);
+	}
+}
+
 void ADonNavigationManager::AbortPathfindingTask_Internal(AActor* Actor)
 {
 	for (int32 i = ActiveNavigationTasks.Num() - 1; i >= 0; i--)
 	{
-		if (ActiveNavigationTasks[i].Data.Actor.Get() == Actor)
+		if (ActiveNavigationTasks[i]->Data.Actor.Get() == Actor)
 		{
 			AbortPathfindingTaskByIndex(i);
 		}
@@ -2496,44 +3207,128 @@ void ADonNavigationManager::AbortPathfindingTask_Internal(AActor* Actor)
 
 void ADonNavigationManager::StopListeningToDynamicCollisionsForPath(FDonNavigationDynamicCollisionDelegate ListenerToClear, UPARAM(ref) const FDoNNavigationQueryData& QueryData)
 {
-	for (int32 i = 0; i < QueryData.VolumeSolutionOptimized.Num(); i++)
+	UnsubscribeFromDynamicCollisions(ListenerToClear, QueryData.DynamicCollisionSubscriptionId);
+}
+
+void ADonNavigationManager::StopListeningToDynamicCollisionsForPathIndex(FDonNavigationDynamicCollisionDelegate ListenerToClear, UPARAM(ref) const FDoNNavigationQueryData& QueryData, const int32 VolumeIndex)
+{
+	auto volume = QueryData.VolumeSolutionOptimized[VolumeIndex]; // Unsafe, but this is a calculated performance-risk trade-off. Callers walk the path within its fixed bounds.
+
+	StopListeningToDynamicCollisionsForVolume(ListenerToClear, QueryData.DynamicCollisionSubscriptionId, volume, QueryData.QueryParams.bPreciseDynamicCollisionRepathing, QueryData.VoxelCollisionProfile);
+}
+
+void ADonNavigationManager::StopListeningToDynamicCollisionsForPathResult(FDonNavigationDynamicCollisionDelegate ListenerToClear, const FDonNavigationPathResultPtr& PathResult)
+{
+	if (!PathResult.IsValid())
+		return;
+
+	UnsubscribeFromDynamicCollisions(ListenerToClear, PathResult->DynamicCollisionSubscriptionId);
+}
+
+void ADonNavigationManager::StopListeningToDynamicCollisionsForPathResultIndex(FDonNavigationDynamicCollisionDelegate ListenerToClear, const FDonNavigationPathResultPtr& PathResult, const int32 PathIndex)
+{
+	if (!PathResult.IsValid() || !PathResult->PathPointVolumeIndices.IsValidIndex(PathIndex))
+		return;
+
+	// PathIndex is a point of Path; its voxels run up to where the next point begins:
+	const auto& pointVolumeIndices = PathResult->PathPointVolumeIndices;
+	const int32 first = pointVolumeIndices[PathIndex];
+	const int32 last = pointVolumeIndices.IsValidIndex(PathIndex + 1) ? FMath::Max(pointVolumeIndices[PathIndex + 1], first + 1) : PathResult->PathVolumes.Num();
+
+	for (int32 i = first; i < last && i < PathResult->PathVolumes.Num(); i++)
+		StopListeningToDynamicCollisionsForVolume(ListenerToClear, PathResult->DynamicCollisionSubscriptionId, PathResult->PathVolumes[i], PathResult->bPreciseDynamicCollisionRepathing, PathResult->VoxelCollisionProfile);
+}
+
+void ADonNavigationManager::SetDynamicCollisionPathProgress(FDonNavigationDynamicCollisionDelegate Listener, UPARAM(ref) const FDoNNavigationQueryData& QueryData, const int32 PathIndex)
+{
+	SetDynamicCollisionPathProgressForSubscription(Listener, QueryData.DynamicCollisionSubscriptionId, PathIndex);
+}
+
+void ADonNavigationManager::SetDynamicCollisionPathResultProgress(FDonNavigationDynamicCollisionDelegate Listener, const FDonNavigationPathResultPtr& PathResult, const int32 PathIndex)
+{
+	if (PathResult.IsValid())
+		SetDynamicCollisionPathProgressForSubscription(Listener, PathResult->DynamicCollisionSubscriptionId, PathIndex);
+}
+
+void ADonNavigationManager::SetDynamicCollisionPathProgressForSubscription(const FDonNavigationDynamicCollisionDelegate& Listener, int32 SubscriptionId, int32 PathIndex)
+{
+	if (SubscriptionId == INDEX_NONE)
+		return;
+
+	FScopeLock lock(&CollisionSubscriptionLock);
+
+	FDonCollisionSubscription* subscription = CollisionSubscriptions.Find(SubscriptionId);
+	if (!subscription || !(subscription->Listener == Listener))
+		return;
+
+	// Nothing left ahead of the listener:
+	if (PathIndex >= subscription->PathPointVolumeIndices.Num())
 	{
-		StopListeningToDynamicCollisionsForPathIndex(ListenerToClear, QueryData, i);
+		RemoveCollisionSubscription_Locked(SubscriptionId);
+		return;
 	}
+
+	// PathIndex is a point of the path, the cursor is an index of its volume list (which also holds every voxel between the points):
+	subscription->ProgressIndex = subscription->PathPointVolumeIndices[FMath::Max(PathIndex, 0)];
 }
 
-void ADonNavigationManager::StopListeningToDynamicCollisionsForPathIndex(FDonNavigationDynamicCollisionDelegate ListenerToClear, UPARAM(ref) const FDoNNavigationQueryData& QueryData, const int32 VolumeIndex)
+void ADonNavigationManager::StopListeningToDynamicCollisionsForVolume(const FDonNavigationDynamicCollisionDelegate& ListenerToClear, int32 SubscriptionId, FDonNavigationVoxel* Volume, bool bPreciseDynamicCollisionRepathing, const FDonVoxelCollisionProfile& VoxelCollisionProfile)
 {
-	auto volume = QueryData.VolumeSolutionOptimized[VolumeIndex]; // Unsafe, but this is a calculated performance-risk trade-off. The most common usecase (it's right above) iterates over fixed bounds.
-	if (!volume)
+	if (!Volume)
 	{
 		UE_LOG(DoNNavigationLog, Warning, TEXT("Invalid path passed to StopListeningToDynamicCollisionsForPath. Ideally this should never happen, please check the source triggering this call."));
 
 		return;
 	}
 
-	volume->DynamicCollisionNotifyees.RemoveAll([&ListenerToClear](const FDonNavigationDynamicCollisionNotifyee& notifyee) {return notifyee.Listener == ListenerToClear; });
+	if (SubscriptionId == INDEX_NONE)
+		return;
+
+	TArray<int32> voxelIds;
+	voxelIds.Add(VoxelIdFor(Volume));
 
-	if (QueryData.QueryParams.bPreciseDynamicCollisionRepathing)
+	if (bPreciseDynamicCollisionRepathing)
 	{
-		for (auto offset : QueryData.VoxelCollisionProfile.RelativeVoxelOccupancy)
+		for (const auto& offset : VoxelCollisionProfile.Offsets())
 		{
-			auto volumeFromProfile = VolumeAtSafe(volume->X + offset.X, volume->Y + offset.Y, volume->Z + offset.Z);
+			auto volumeFromProfile = VolumeAtSafe(Volume->X + offset.X, Volume->Y + offset.Y, Volume->Z + offset.Z);
 			if (volumeFromProfile)
-				volumeFromProfile->DynamicCollisionNotifyees.RemoveAll([&ListenerToClear](const FDonNavigationDynamicCollisionNotifyee& notifyee) {return notifyee.Listener == ListenerToClear; });
+				voxelIds.Add(VoxelIdFor(volumeFromProfile));
 		}
 	}
+
+	FScopeLock lock(&CollisionSubscriptionLock);
+
+	FDonCollisionSubscription* subscription = CollisionSubscriptions.Find(SubscriptionId);
+	if (!subscription || !(subscription->Listener == ListenerToClear))
+		return;
+
+	TArray<int32> removedIds;
+	for (int32 voxelId : voxelIds)
+	{
+		const int32 index = Algo::BinarySearch(subscription->VoxelIds, voxelId);
+		if (index == INDEX_NONE)
+			continue;
+
+		subscription->VoxelIds.RemoveAt(index, 1, EAllowShrinking::No);
+		removedIds.Add(voxelId);
+	}
+
+	if (!subscription->VoxelIds.Num())
+		CollisionSubscriptions.Remove(SubscriptionId);
+
+	RemoveCollisionSubscribers_Locked(SubscriptionId, removedIds);
 }
 
 void ADonNavigationManager::AbortPathfindingTaskByIndex(int32 TaskIndex)
 {
-	auto owner = ActiveNavigationTasks[TaskIndex].Data.Actor.Get();
-
-	auto collisionListener = ActiveNavigationTasks[TaskIndex].DynamicCollisionListener;
+	auto task = ActiveNavigationTasks[TaskIndex];
+	auto owner = task->Data.Actor.Get();
 
-	StopListeningToDynamicCollisionsForPath(collisionListener, ActiveNavigationTasks[TaskIndex].Data);
+	StopListeningToDynamicCollisionsForPath(task->DynamicCollisionListener, task->Data);
 		
 	ActiveNavigationTasks.RemoveAtSwap(TaskIndex);
+	QueryTaskPool.Release(task);
 
 #if DEBUG_DoNAI_THREADS
 	UE_LOG(DoNNavigationLog, Display, TEXT("[%s] [%s] Executing new abort request"), owner ? *owner->GetName() : *FString("Unknown"), IsInGameThread() ? *FString("[game thread]") : *FString("[async thread]"));
@@ -2541,18 +3336,313 @@ void ADonNavigationManager::AbortPathfindingTaskByIndex(int32 TaskIndex)
 }
 
 
+// Flow fields
+
+int32 ADonNavigationManager::ScheduleFlowField(FVector Goal, int32 RegionRadiusVoxels, UPrimitiveComponent* AgentCollisionComponent)
+{
+	if (bIsUnbound)
+	{
+		UE_LOG(DoNNavigationLog, Error, TEXT("Flow fields are only supported for bound (finite) worlds"));
+
+		return INDEX_NONE;
+	}
+
+	auto goalVolume = VolumeAt(Goal);
+	if (!goalVolume)
+	{
+		UE_LOG(DoNNavigationLog, Error, TEXT("Flow field goal %s is outside the navigable world"), *Goal.ToString());
+
+		return INDEX_NONE;
+	}
+
+	FDonFlowFieldTask task;
+	task.FlowFieldId = NextFlowFieldId++;
+	task.GoalVolume = goalVolume;
+	task.GoalLocation = Goal;
+
+	if (AgentCollisionComponent)
+	{
+		bool bResultIsValid = false;
+		const bool bIgnoreMeshOriginOccupancy = true;
+		task.VoxelCollisionProfile = GetVoxelCollisionProfileFromMesh(FDonMeshIdentifier(AgentCollisionComponent), bResultIsValid, VoxelCollisionProfileCache_GameThread, bIgnoreMeshOriginOccupancy);
+
+		// Building for a point-sized agent instead would steer this agent into walls:
+		if (!bResultIsValid)
+		{
+			UE_LOG(DoNNavigationLog, Warning, TEXT("Flow field for %s not scheduled: failed to sample the agent's voxel collision profile"), *AgentCollisionComponent->GetName());
+
+			return INDEX_NONE;
+		}
+
+		task.AgentSizeLayer = SelectAgentSizeLayer(task.VoxelCollisionProfile);
+	}
+
+	// Clamp the region to the world, then shrink it around the goal until it fits the memory budget:
+	int32 radius = FMath::Max(RegionRadiusVoxels, 0);
+
+	while (true)
+	{
+		task.MinX = FMath::Max(goalVolume->X - radius, 0);
+		task.MinY = FMath::Max(goalVolume->Y - radius, 0);
+		task.MinZ = FMath::Max(goalVolume->Z - radius, 0);
+		task.SizeX = FMath::Min(goalVolume->X + radius, XGridSize - 1) - task.MinX + 1;
+		task.SizeY = FMath::Min(goalVolume->Y + radius, YGridSize - 1) - task.MinY + 1;
+		task.SizeZ = FMath::Min(goalVolume->Z + radius, ZGridSize - 1) - task.MinZ + 1;
+
+		if (task.NumCells() <= MaxFlowFieldVoxels || radius == 0)
+			break;
+
+		radius--;
+	}
+
+	if (radius < RegionRadiusVoxels)
+		UE_LOG(DoNNavigationLog, Warning, TEXT("Flow field region radius reduced from %d to %d voxels to stay within MaxFlowFieldVoxels (%d)"), RegionRadiusVoxels, radius, MaxFlowFieldVoxels);
+
+	ActiveFlowFieldIds.Add(task.FlowFieldId);
+	AddFlowFieldTask(task);
+
+	return task.FlowFieldId;
+}
+
+void ADonNavigationManager::ReleaseFlowField(int32 FlowFieldId)
+{
+	if (!ActiveFlowFieldIds.Remove(FlowFieldId))
+		return;
+
+	PublishedFlowFields.Remove(FlowFieldId);
+
+	FDonFlowFieldTask task;
+	task.FlowFieldId = FlowFieldId;
+	task.RequestType = EDonFlowFieldRequestType::Release;
+
+	AddFlowFieldTask(task);
+}
+
+bool ADonNavigationManager::SampleFlowField(int32 FlowFieldId, FVector Location, FVector& Direction) const
+{
+	const FDonFlowFieldSnapshotPtr* snapshot = PublishedFlowFields.Find(FlowFieldId);
+
+	return snapshot && (*snapshot)->Sample(Location, Direction);
+}
+
+FDonFlowFieldSnapshotPtr ADonNavigationManager::GetFlowFieldSnapshot(int32 FlowFieldId) const
+{
+	const FDonFlowFieldSnapshotPtr* snapshot = PublishedFlowFields.Find(FlowFieldId);
+
+	return snapshot ? *snapshot : FDonFlowFieldSnapshotPtr();
+}
+
+void ADonNavigationManager::AddFlowFieldTask(FDonFlowFieldTask& Task)
+{
+	if (!bMultiThreadingEnabled)
+		AcceptFlowFieldTask(Task);
+	else
+		NewFlowFieldTasks.Enqueue(Task);
+}
+
+void ADonNavigationManager::AcceptFlowFieldTask(FDonFlowFieldTask& Task)
+{
+	if (Task.RequestType == EDonFlowFieldRequestType::Release)
+	{
+		const int32 flowFieldId = Task.FlowFieldId;
+		ActiveFlowFields.RemoveAll([flowFieldId](const FDonFlowFieldTask& FlowField) { return FlowField.FlowFieldId == flowFieldId; });
+	}
+	else
+		ActiveFlowFields.Add(Task);
+}
+
+void ADonNavigationManager::ReceiveAsyncFlowFieldTasks()
+{
+	FDonFlowFieldTask task;
+
+	while (NewFlowFieldTasks.Dequeue(task))
+		AcceptFlowFieldTask(task);
+}
+
+void ADonNavigationManager::ReceiveAsyncFlowFields()
+{
+	FDonFlowFieldSnapshotPtr snapshot;
+
+	while (CompletedFlowFields.Dequeue(snapshot))
+	{
+		// Released while this build was in flight?
+		if (ActiveFlowFieldIds.Contains(snapshot->FlowFieldId))
+			PublishedFlowFields.Add(snapshot->FlowFieldId, snapshot);
+	}
+}
+
+void ADonNavigationManager::BeginFlowFieldBuild(FDonFlowFieldTask& Task)
+{
+	const int32 numCells = Task.NumCells();
+
+	Task.Costs.Init(MAX_uint32, numCells);
+	Task.Settled.Init(false, numCells);
+	Task.Directions.Init(FDonFlowFieldSnapshot::Unreachable, numCells);
+	Task.Frontier = DoNNavigation::PriorityQueue<int32>();
+
+	const int32 goalCell = Task.CellIndex(Task.GoalVolume->X, Task.GoalVolume->Y, Task.GoalVolume->Z);
+	Task.Costs[goalCell] = 0;
+	Task.Directions[goalCell] = FDonFlowFieldSnapshot::AtGoal;
+	Task.Frontier.put(goalCell, 0);
+
+	Task.bDirty = false;
+	Task.bBuildInProgress = true;
+}
+
+void ADonNavigationManager::PublishFlowField(FDonFlowFieldTask& Task)
+{
+	auto snapshot = MakeShared<FDonFlowFieldSnapshot, ESPMode::ThreadSafe>();
+
+	static_cast<FDonFlowFieldRegion&>(*snapshot) = Task;
+	snapshot->FlowFieldId = Task.FlowFieldId;
+	snapshot->Version = ++Task.Version;
+	snapshot->GridOrigin = GetActorLocation();
+	snapshot->VoxelSize = VoxelSize;
+	snapshot->GoalLocation = Task.GoalLocation;
+	snapshot->Directions = MoveTemp(Task.Directions);
+
+	// Only the directions are kept once a build is complete:
+	Task.Costs.Empty();
+	Task.Settled.Empty();
+	Task.bBuildInProgress = false;
+
+	if (!bMultiThreadingEnabled)
+		PublishedFlowFields.Add(Task.FlowFieldId, snapshot);
+	else
+		CompletedFlowFields.Enqueue(snapshot);
+}
+
+void ADonNavigationManager::TickScheduledFlowFieldTasks(int32 MaxIterationsPerTick)
+{
+	ApplyDirtyFlowFieldRegions();
+
+	int32 numBuilds = 0;
+
+	for (auto& task : ActiveFlowFields)
+	{
+		// A field whose region changed is rebuilt from scratch; the previous snapshot keeps serving until the new one is published
+		if (task.bDirty && !task.bBuildInProgress)
+			BeginFlowFieldBuild(task);
+
+		if (task.bBuildInProgress)
+			numBuilds++;
+	}
+
+	if (!numBuilds)
+		return;
+
+	const int32 maxIterationsPerBuild = FMath::Max(MaxIterationsPerTick / numBuilds, 1);
+
+	for (auto& task : ActiveFlowFields)
+	{
+		if (!task.bBuildInProgress)
+			continue;
+
+		// Dijkstra outwards from the goal, recording for every voxel the neighbor it was reached from:
+		for (int32 i = 0; i < maxIterationsPerBuild && !task.Frontier.empty(); i++)
+		{
+			const int32 cell = task.Frontier.get();
+
+			if (task.Settled[cell])
+				continue;
+
+			task.Settled[cell] = true;
+
+			int32 x, y, z;
+			task.VoxelAtCell(cell, x, y, z);
+
+			const uint32 cost = task.Costs[cell];
+			const auto& neighbors = FindOrSetupNeighborsForVolume(&VolumeAtUnsafe(x, y, z));
+
+			for (auto neighbor : neighbors)
+			{
+				if (!task.ContainsVoxel(neighbor->X, neighbor->Y, neighbor->Z))
+					continue;
+
+				const int32 neighborCell = task.CellIndex(neighbor->X, neighbor->Y, neighbor->Z);
+
+				// Unlike the query solver, diagonals are costed by their true length here (sqrt 2 for edge moves, sqrt 3 for corner moves):
+				// a flow field is followed verbatim, without an optimization pass
+				const int32 dx = x - neighbor->X, dy = y - neighbor->Y, dz = z - neighbor->Z;
+				const int32 numAxes = FMath::Abs(dx) + FMath::Abs(dy) + FMath::Abs(dz);
+				const uint32 newCost = cost + static_cast<uint32>(VoxelSize * FMath::Sqrt(static_cast<float>(numAxes)));
+
+				if (task.Settled[neighborCell] || newCost >= task.Costs[neighborCell])
+					continue;
+
+				if (!CanNavigateForAgent(neighbor, task.VoxelCollisionProfile, task.AgentSizeLayer))
+					continue;
+
+				task.Costs[neighborCell] = newCost;
+				task.Directions[neighborCell] = FDonFlowFieldSnapshot::PackDirection(dx, dy, dz);
+				task.Frontier.put(neighborCell, newCost);
+			}
+		}
+
+		if (task.Frontier.empty())
+			PublishFlowField(task);
+	}
+}
+
+void ADonNavigationManager::TickScheduledFlowFieldTasks_Safe(int32 MaxIterationsPerTick)
+{
+	TickScheduledFlowFieldTasks(MaxIterationsPerTick);
+}
+
+void ADonNavigationManager::InvalidateFlowFields(const FDonFlowFieldDirtyRegion& Region)
+{
+	for (auto& task : ActiveFlowFields)
+	{
+		// Large agents are affected by changes within their own reach of the region:
+		const int32 reach = AgentReachInVoxels(task.VoxelCollisionProfile, task.AgentSizeLayer);
+
+		if (task.Intersects(Region.Min.X - reach, Region.Min.Y - reach, Region.Min.Z - reach, Region.Max.X + reach, Region.Max.Y + reach, Region.Max.Z + reach))
+			task.bDirty = true;
+	}
+}
+
+void ADonNavigationManager::ApplyDirtyFlowFieldRegions()
+{
+	FDonFlowFieldDirtyRegion region;
+
+	while (DirtyFlowFieldRegions.Dequeue(region))
+		InvalidateFlowFields(region);
+}
+
+void ADonNavigationManager::InvalidateFlowFieldsForProfile(const FDonVoxelCollisionProfile& Profile, int32 OriginX, int32 OriginY, int32 OriginZ)
+{
+	// Dynamic collision updates also run on the game thread (synchronous and cheap-bounds updates) while the flow fields belong to the solver thread,
+	// so the region is only queued here (see ApplyDirtyFlowFieldRegions)
+	DirtyFlowFieldRegions.Enqueue(FDonFlowFieldDirtyRegion(FIntVector(OriginX + Profile.OffsetsMin.X, OriginY + Profile.OffsetsMin.Y, OriginZ + Profile.OffsetsMin.Z),
+														   FIntVector(OriginX + Profile.OffsetsMax.X, OriginY + Profile.OffsetsMax.Y, OriginZ + Profile.OffsetsMax.Z)));
+}
+
 void ADonNavigationManager::TickNavigationSolver(FDonNavigationQueryTask& task)
 {	
 	auto& data = task.Data;
 
 	data.SolverIterationCount++;
 
+	if (data.SearchCorridorExpansions.Num())
+		data.SearchCorridorExpansions.Last()++;
+
 	if (!data.Frontier.empty())
 	{
 		// Move towards goal by fetching the "best neighbor" of the previous volume from the Frontier priority queue
 		// The best neighbor is defined as the node most likely to lead us towards the goal
 		auto currentVolume = data.Frontier.get(); 
 
+		if (data.UsesLazyThetaStar())
+		{
+			bool bAlreadyClosed = false;
+			data.LazyThetaClosedVolumes.Add(currentVolume, &bAlreadyClosed);
+
+			if (bAlreadyClosed)
+				return;
+
+			UpdateAnyAngleParent(task, currentVolume);
+		}
+
 		// Have we reached the goal?
 		if (currentVolume == data.DestinationVolume)
 		{
@@ -2560,6 +3650,15 @@ void ADonNavigationManager::TickNavigationSolver(FDonNavigationQueryTask& task)
 			return;
 		}
 
+		if (data.HeuristicWeight > 1.f)
+		{
+			bool bAlreadyClosed = false;
+			data.AnytimeClosedVolumes.Add(currentVolume, &bAlreadyClosed);
+
+			if (bAlreadyClosed)
+				return;
+		}
+
 		// Discover all neighbors for current volume:
 		const auto& neighbors = FindOrSetupNeighborsForVolume(currentVolume);
 		
@@ -2578,11 +3677,22 @@ void ADonNavigationManager::PackageRawSolution(FDonNavigationQueryTask& task)
 	if (bIsUnbound)
 		return;
 
-	for (auto solutionNode : task.Data.PathSolutionRaw)
+	// Any-angle paths skip over voxels between their points, which need listening to as well:
+	if (task.Data.UsesLazyThetaStar())
 	{
-		auto volume = AppendVolumeList(solutionNode, task);
-		AddCollisionListenerToVolumeFromTask(volume, task);
-	}	
+		for (int32 i = 0; i < task.Data.PathSolutionRaw.Num() - 1; i++)
+			AppendVolumeListFromRange(task.Data.PathSolutionRaw[i], task.Data.PathSolutionRaw[i + 1], task);
+
+		if (task.Data.PathSolutionRaw.Num())
+			AppendVolumeList(task.Data.PathSolutionRaw.Last(), task);
+	}
+	else
+	{
+		for (auto solutionNode : task.Data.PathSolutionRaw)
+			AppendVolumeList(solutionNode, task);
+	}
+
+	SubscribeToDynamicCollisions(task);
 }
 
 void ADonNavigationManager::PackageDirectSolution(FDonNavigationQueryTask& Task)
@@ -2596,8 +3706,7 @@ void ADonNavigationManager::PackageDirectSolution(FDonNavigationQueryTask& Task)
 		if (!Task.Data.QueryParams.bIgnoreDynamicCollisionRepathingForDirectGoals)
 		{
 			AppendVolumeListFromRange(Task.Data.Origin, Task.Data.Destination, Task);
-			for(auto volume : Task.Data.VolumeSolutionOptimized)
-				AddCollisionListenerToVolumeFromTask(volume, Task);
+			SubscribeToDynamicCollisions(Task);
 
 			Task.Data.VolumeSolution = Task.Data.VolumeSolutionOptimized;
 		}
@@ -2610,37 +3719,782 @@ void ADonNavigationManager::PackageDirectSolution(FDonNavigationQueryTask& Task)
 	}
 }
 
-void ADonNavigationManager::TickScheduledPathfindingTasks(float DeltaSeconds, int32 MaxIterationsPerTick)
+FDonPathCacheKey ADonNavigationManager::PathCacheKeyForQuery(const FDoNNavigationQueryData& QueryData) const
 {
-	const int32 numTasks = ActiveNavigationTasks.Num();
-	int32 maxTasksThisIteration = 0, maxIterationsPerTask = 0;
-
-	if (!numTasks)
-		return;
+	FDonPathCacheKey key;
+	key.OriginVolume = QueryData.OriginVolume;
+	key.DestinationVolume = QueryData.DestinationVolume;
+	key.SizeClass = AgentReachInVoxels(QueryData.VoxelCollisionProfile, QueryData.AgentSizeLayer);
+	key.CollisionShapeInflation = QueryData.QueryParams.CollisionShapeInflation;
 
-	if (numTasks <= MaxIterationsPerTick)
+	// Paths are optimized with sweeps of the query's own collision shape, so only agents of the same shape may share them:
+	if (UPrimitiveComponent* collisionComponent = QueryData.CollisionComponent.Get())
 	{
-		maxTasksThisIteration = numTasks;
-		maxIterationsPerTask = MaxIterationsPerTick / numTasks;
+		const FCollisionShape shape = collisionComponent->GetCollisionShape(QueryData.QueryParams.CollisionShapeInflation);
+		const FVector extent = shape.GetExtent();
+
+		key.ShapeType = static_cast<int32>(shape.ShapeType);
+		key.ShapeExtent = FIntVector(FMath::CeilToInt(extent.X), FMath::CeilToInt(extent.Y), FMath::CeilToInt(extent.Z));
+	}
+
+	return key;
+}
+
+bool ADonNavigationManager::ServeFromPathCache(FDonNavigationQueryTask& Task)
+{
+	auto& data = Task.Data;
+
+	if (!bEnablePathCache || bIsUnbound || !data.OriginVolume || !data.DestinationVolume)
+		return false;
+
+	const FDonPathCacheKey key = PathCacheKeyForQuery(data);
+	const double now = FPlatformTime::Seconds();
+
+	{
+		FScopeLock lock(&PathCacheLock);
+
+		FDonPathCacheEntry* entry = PathCache.Find(key);
+		if (entry && PathCacheTimeToLive > 0.f && now - entry->TimeAdded > PathCacheTimeToLive)
+		{
+			RemovePathCacheEntry_Locked(key);
+			entry = NULL;
+		}
+
+		if (!entry)
+		{
+			PathCacheMisses.Increment();
+
+			return false;
+		}
+
+		entry->TimeLastUsed = now;
+
+		data.VolumeSolution = entry->VolumeSolution;
+		data.VolumeSolutionOptimized = entry->VolumeSolutionOptimized;
+		data.PathSolutionRaw = entry->PathSolutionRaw;
+		data.PathSolutionOptimized = entry->PathSolutionOptimized;
+	}
+
+	// Paths begin at the center of the origin voxel (shared by all queries using this entry) but end at the exact destination of the query which solved it.
+	// Our destination is elsewhere in the same voxel, so the final hop of the optimized path must be confirmed again before the path can be reused:
+	if (data.PathSolutionOptimized.Num())
+	{
+		const int32 lastIndex = data.PathSolutionOptimized.Num() - 1;
+		const FVector finalHopStart = lastIndex > 0 ? data.PathSolutionOptimized[lastIndex - 1] : data.Origin;
+
+		FHitResult OutHit;
+		if (!IsDirectPathLineSweep(data.CollisionComponent.Get(), finalHopStart, data.Destination, OutHit, true, data.QueryParams.CollisionShapeInflation))
+		{
+			data.VolumeSolution.Empty();
+			data.VolumeSolutionOptimized.Empty();
+			data.PathSolutionRaw.Empty();
+			data.PathSolutionOptimized.Empty();
+
+			PathCacheMisses.Increment();
+
+			return false;
+		}
+
+		// The voxels of the final hop are traced again for the new end point:
+		if (lastIndex > 0)
+		{
+			MapPathPointsToVolumes(data);
+			data.VolumeSolutionOptimized.SetNum(data.PathPointVolumeIndices[lastIndex - 1]);
+			AppendVolumeListFromRange(finalHopStart, data.Destination, Task);
+		}
+
+		data.PathSolutionOptimized[lastIndex] = data.Destination;
+	}
+
+	if (data.PathSolutionRaw.Num())
+		data.PathSolutionRaw.Last() = data.Destination;
+
+	PathCacheHits.Increment();
+
+	data.bGoalFound = true;
+	data.bGoalOptimized = true;
+	data.bServedFromPathCache = true;
+
+	SubscribeToDynamicCollisions(Task);
+
+	VisualizeSolution(data.Origin, data.Destination, data.PathSolutionRaw, data.PathSolutionOptimized, data.DebugParams);
+
+	data.QueryStatus = EDonNavigationQueryStatus::Success;
+
+	return true;
+}
+
+void ADonNavigationManager::AddToPathCache(const FDonNavigationQueryTask& Task)
+{
+	const auto& data = Task.Data;
+
+	if (!bEnablePathCache || bIsUnbound || !data.OriginVolume || !data.DestinationVolume || !data.VolumeSolutionOptimized.Num())
+		return;
+
+	const FDonPathCacheKey key = PathCacheKeyForQuery(data);
+	const double now = FPlatformTime::Seconds();
+
+	FDonPathCacheEntry entry;
+	entry.VolumeSolution = data.VolumeSolution;
+	entry.VolumeSolutionOptimized = data.VolumeSolutionOptimized;
+	entry.PathSolutionRaw = data.PathSolutionRaw;
+	entry.PathSolutionOptimized = data.PathSolutionOptimized;
+	entry.TimeAdded = entry.TimeLastUsed = now;
+
+	// Large pawns need the space around the path as well, same as with bPreciseDynamicCollisionRepathing:
+	TSet<FDonNavigationVoxel*> watchedVolumes;
+	for (auto volume : data.VolumeSolutionOptimized)
+	{
+		if (!volume)
+			continue;
+
+		watchedVolumes.Add(volume);
+
+		for (const auto& offset : data.VoxelCollisionProfile.Offsets())
+		{
+			auto volumeFromProfile = NeighborAt(volume, offset);
+			if (volumeFromProfile)
+				watchedVolumes.Add(volumeFromProfile);
+		}
 	}
-	else
-	{
-		maxTasksThisIteration = MaxIterationsPerTick;
-		maxIterationsPerTask = 1;
-	}	
 
-	for (int32 i = maxTasksThisIteration - 1; i >= 0; i--)
+	entry.WatchedVolumes = watchedVolumes.Array();
+
+	FScopeLock lock(&PathCacheLock);
+
+	RemovePathCacheEntry_Locked(key);
+
+	// Evict the least recently used paths to make room:
+	while (PathCache.Num() && PathCache.Num() >= FMath::Max(PathCacheCapacity, 1))
+	{
+		auto leastRecentlyUsed = PathCache.CreateConstIterator();
+		for (auto it = PathCache.CreateConstIterator(); it; ++it)
+		{
+			if (it.Value().TimeLastUsed < leastRecentlyUsed.Value().TimeLastUsed)
+				leastRecentlyUsed = it;
+		}
+
+		RemovePathCacheEntry_Locked(leastRecentlyUsed.Key());
+	}
+
+	for (auto volume : entry.WatchedVolumes)
+		PathCacheVolumeIndex.Add(volume, key);
+
+	PathCache.Add(key, MoveTemp(entry));
+}
+
+void ADonNavigationManager::InvalidatePathCache(const TArray<FDonNavigationVoxel*>& OccupiedVolumes)
+{
+	FScopeLock lock(&PathCacheLock);
+
+	if (!PathCache.Num())
+		return;
+
+	TArray<FDonPathCacheKey> invalidatedKeys;
+
+	for (auto volume : OccupiedVolumes)
+		PathCacheVolumeIndex.MultiFind(volume, invalidatedKeys);
+
+	for (const auto& key : invalidatedKeys)
+	{
+		if (PathCache.Contains(key))
+		{
+			RemovePathCacheEntry_Locked(key);
+			PathCacheInvalidations.Increment();
+		}
+	}
+}
+
+void ADonNavigationManager::RemovePathCacheEntry_Locked(const FDonPathCacheKey& Key)
+{
+	const FDonPathCacheEntry* entry = PathCache.Find(Key);
+	if (!entry)
+		return;
+
+	for (auto volume : entry->WatchedVolumes)
+		PathCacheVolumeIndex.RemoveSingle(volume, Key);
+
+	PathCache.Remove(Key);
+}
+
+float ADonNavigationManager::GetPathCacheHitRate() const
+{
+	const int32 hits = PathCacheHits.GetValue();
+	const int32 lookups = hits + PathCacheMisses.GetValue();
+
+	return lookups ? (float)hits / lookups : 0.f;
+}
+
+void ADonNavigationManager::GetPathCacheStats(int32& Hits, int32& Misses, int32& Invalidations, int32& NumEntries)
+{
+	Hits = PathCacheHits.GetValue();
+	Misses = PathCacheMisses.GetValue();
+	Invalidations = PathCacheInvalidations.GetValue();
+
+	FScopeLock lock(&PathCacheLock);
+	NumEntries = PathCache.Num();
+}
+
+void ADonNavigationManager::ClearPathCache()
+{
+	FScopeLock lock(&PathCacheLock);
+
+	PathCache.Empty();
+	PathCacheVolumeIndex.Empty();
+}
+
+bool ADonNavigationManager::CanJoinCoalescedSearch(const FDoNNavigationQueryData& QueryData, const FDonCoalescedSearch& Search)
+{
+	// Retained searches are private to their owner
+	if (Search.RetainedBy)
+		return false;
+
+	// Same agent size?
+	if (QueryData.AgentSizeLayer != Search.AgentSizeLayer)
+		return false;
+
+	if (QueryData.AgentSizeLayer == INDEX_NONE && !QueryData.VoxelCollisionProfile.HasSameOffsets(Search.VoxelCollisionProfile))
+		return false;
+
+	// Same (or close enough) goal?
+	const auto goal = Search.GoalVolume;
+	const auto destination = QueryData.DestinationVolume;
+
+	if (destination == goal)
+		return true;
+
+	const int32 tolerance = CoalescingDestinationToleranceVoxels;
+	if (FMath::Abs(destination->X - goal->X) > tolerance || FMath::Abs(destination->Y - goal->Y) > tolerance || FMath::Abs(destination->Z - goal->Z) > tolerance)
+		return false;
+
+	// The member's path ends with a straight hop from the shared goal to its own destination, so that hop must be clear:
+	FHitResult hitResult;
+	const bool bFindInitialOverlaps = true;
+
+	return QueryData.CollisionComponent.IsValid() && IsDirectPathLineSweep(QueryData.CollisionComponent.Get(), goal->Location, QueryData.Destination, hitResult, bFindInitialOverlaps, QueryData.QueryParams.CollisionShapeInflation);
+}
+
+void ADonNavigationManager::JoinCoalescedSearch(FDonNavigationQueryTask& Task, int32 SearchId, FDonCoalescedSearch& Search)
+{
+	auto& data = Task.Data;
+
+	data.CoalescedSearchId = SearchId;
+
+	Search.MemberOrigins.Add(data.OriginVolume);
+	Search.NumMembers++;
+}
+
+void ADonNavigationManager::CoalesceNewPathfindingTasks()
+{
+	// Only queries which haven't begun solving are considered, so every query is looked at exactly once
+	TArray<int32, TInlineAllocator<25>> candidates;
+
+	for (int32 i = 0; i < ActiveNavigationTasks.Num(); i++)
+	{
+		const auto& data = ActiveNavigationTasks[i]->Data;
+
+		if (!data.SolverIterationCount && data.CoalescedSearchId == INDEX_NONE && !data.bGoalFound && data.OriginVolume && data.DestinationVolume && !data.QueryParams.bRetainSearchForRepair && !data.QueryParams.bAnytimePlanning)
+			candidates.Add(i);
+	}
+
+	if (!candidates.Num())
+		return;
+
+	// Join searches that are already running:
+	for (int32 c = candidates.Num() - 1; c >= 0; c--)
+	{
+		auto& task = *ActiveNavigationTasks[candidates[c]];
+
+		for (auto& search : CoalescedSearches)
+		{
+			if (CanJoinCoalescedSearch(task.Data, search.Value))
+			{
+				JoinCoalescedSearch(task, search.Key, search.Value);
+				candidates.RemoveAt(c);
+
+				break;
+			}
+		}
+	}
+
+	// Group the remaining queries by destination:
+	TArray<int32, TInlineAllocator<25>> group;
+
+	while (candidates.Num() >= MinQueriesToCoalesce)
+	{
+		const auto& founder = ActiveNavigationTasks[candidates[0]]->Data;
+
+		FDonCoalescedSearch search;
+		search.GoalVolume = founder.DestinationVolume;
+		search.VoxelCollisionProfile = founder.VoxelCollisionProfile;
+		search.AgentSizeLayer = founder.AgentSizeLayer;
+
+		group.Reset();
+		group.Add(candidates[0]);
+
+		for (int32 c = 1; c < candidates.Num(); c++)
+		{
+			if (CanJoinCoalescedSearch(ActiveNavigationTasks[candidates[c]]->Data, search))
+				group.Add(candidates[c]);
+		}
+
+		for (auto taskIndex : group)
+			candidates.Remove(taskIndex);
+
+		if (group.Num() < MinQueriesToCoalesce)
+			continue;
+
+		search.Frontier.put(search.GoalVolume, 0);
+		search.VolumeVsCostMap.Add(search.GoalVolume, 0);
+
+		const int32 searchId = NextCoalescedSearchId++;
+		auto& addedSearch = CoalescedSearches.Add(searchId, MoveTemp(search));
+
+		for (auto taskIndex : group)
+			JoinCoalescedSearch(*ActiveNavigationTasks[taskIndex], searchId, addedSearch);
+
+		UE_LOG(DoNNavigationLog, Verbose, TEXT("Coalesced %d queries towards %s into a single reverse search"), group.Num(), *addedSearch.GoalVolume->Location.ToString());
+	}
+}
+
+void ADonNavigationManager::TickCoalescedSearch(FDonCoalescedSearch& Search, int32 MaxIterations)
+{
+	for (int32 i = 0; i < MaxIterations && !Search.Frontier.empty(); i++)
+	{
+		auto currentVolume = Search.Frontier.get();
+
+		// Stale frontier entry? (a cheaper route to this volume was settled earlier)
+		if (Search.SettledVolumes.Contains(currentVolume))
+			continue;
+
+		Search.SettledVolumes.Add(currentVolume);
+
+		const uint32 newCost = Search.VolumeVsCostMap.FindChecked(currentVolume) + VoxelSize;
+		const auto& neighbors = FindOrSetupNeighborsForVolume(currentVolume);
+
+		for (auto neighbor : neighbors)
+		{
+			// Member origins are occupied by the members themselves, so (as with the forward solver) they are exempt from the navigability test:
+			if (!Search.MemberOrigins.Contains(neighbor) && !CanNavigateForAgent(neighbor, Search.VoxelCollisionProfile, Search.AgentSizeLayer))
+				continue;
+
+			uint32* volumeCost = Search.VolumeVsCostMap.Find(neighbor);
+
+			if (!volumeCost || newCost < *volumeCost)
+			{
+				Search.VolumeVsParentMap.Add(neighbor, currentVolume);
+				Search.VolumeVsCostMap.Add(neighbor, newCost);
+				Search.SettledVolumes.Remove(neighbor); // reopened (only possible with a heuristic, as with the regular solver)
+
+				const uint32 heuristic = Search.HeuristicTarget ? FVector::Dist(neighbor->Location, Search.HeuristicTarget->Location) : 0;
+				Search.Frontier.put(neighbor, newCost + heuristic);
+			}
+		}
+	}
+}
+
+void ADonNavigationManager::TickCoalescedQuery(FDonNavigationQueryTask& Task, int32& IterationsProcessed, const int32 MaxIterationsPerTask)
+{
+	auto& data = Task.Data;
+
+	auto search = CoalescedSearches.Find(data.CoalescedSearchId);
+	if (!search)
+		return;
+
+	// Each waiting member lends its share of the solver budget to the shared search:
+	if (!search->SettledVolumes.Contains(data.OriginVolume))
+	{
+		const int32 budget = FMath::Max(MaxIterationsPerTask - IterationsProcessed + 1, 0);
+
+		TickCoalescedSearch(*search, budget);
+
+		IterationsProcessed += budget;
+		data.SolverIterationCount += budget;
+	}
+
+	if (search->SettledVolumes.Contains(data.OriginVolume))
+		data.bGoalFound = data.bSolutionFromCoalescedSearch = ExtractCoalescedSolution(Task, *search);
+	else if (search->Frontier.empty())
+		data.Frontier = DoNNavigation::PriorityQueue<FDonNavigationVoxel*>(); // shared search is exhausted, let the regular "no solution" route report it
+}
+
+bool ADonNavigationManager::ExtractCoalescedSolution(FDonNavigationQueryTask& Task, const FDonCoalescedSearch& Search)
+{
+	auto& data = Task.Data;
+
+	data.VolumeSolution.Reset();
+	data.PathSolutionRaw.Reset();
+
+	// Walk the parent map from the origin down to the shared goal:
+	auto volume = data.OriginVolume;
+
+	while (volume)
+	{
+		data.VolumeSolution.Add(volume);
+
+		if (volume == Search.GoalVolume)
+			break;
+
+		auto parent = Search.VolumeVsParentMap.Find(volume);
+		volume = parent ? *parent : NULL;
+	}
+
+	if (data.VolumeSolution.Last() != Search.GoalVolume)
+	{
+		UE_LOG(DoNNavigationLog, Error, TEXT("Coalesced search for %s settled the origin but no route to the goal was recorded"), *data.GetActorName());
+
+		return false;
+	}
+
+	// Joined within tolerance? Finish with the (already swept) hop to our own destination:
+	if (data.DestinationVolume != Search.GoalVolume || data.VolumeSolution.Num() == 1)
+		data.VolumeSolution.Add(data.DestinationVolume);
+
+	// Same layout as PathSolutionFromVolumeTrajectoryMap: volume centers, with the final volume replaced by the exact destination
+	data.PathSolutionRaw.Reserve(data.VolumeSolution.Num());
+
+	if (data.OriginVolume == data.DestinationVolume)
+		data.PathSolutionRaw.Add(data.Origin);
+	else
+	{
+		for (int32 i = 0; i < data.VolumeSolution.Num() - 1; i++)
+			data.PathSolutionRaw.Add(data.VolumeSolution[i]->Location);
+	}
+
+	data.PathSolutionRaw.Add(data.Destination);
+
+	return true;
+}
+
+void ADonNavigationManager::ReleaseIdleCoalescedSearches()
+{
+	if (!CoalescedSearches.Num())
+		return;
+
+	TSet<int32> searchesInUse;
+
+	for (const auto task : ActiveNavigationTasks)
+	{
+		if (task->Data.CoalescedSearchId != INDEX_NONE && !task->Data.bGoalFound)
+			searchesInUse.Add(task->Data.CoalescedSearchId);
+	}
+
+	for (auto it = CoalescedSearches.CreateIterator(); it; ++it)
+	{
+		if (!it.Value().RetainedBy && !searchesInUse.Contains(it.Key()))
+			it.RemoveCurrent();
+	}
+}
+
+void ADonNavigationManager::AttachRetainedSearches()
+{
+	for (auto taskPtr : ActiveNavigationTasks)
+	{
+		auto& task = *taskPtr;
+		auto& data = task.Data;
+		auto owner = data.Actor.Get();
+
+		if (!data.QueryParams.bRetainSearchForRepair || !owner || data.SolverIterationCount || data.CoalescedSearchId != INDEX_NONE || data.bGoalFound || !data.OriginVolume || !data.DestinationVolume)
+			continue;
+
+		// Can the owner's previous search be repaired for this query? (same goal, same agent)
+		const int32* retainedSearchId = RetainedSearchIdByOwner.Find(owner);
+		FDonCoalescedSearch* search = retainedSearchId ? CoalescedSearches.Find(*retainedSearchId) : NULL;
+
+		if (search && search->GoalVolume == data.DestinationVolume && search->AgentSizeLayer == data.AgentSizeLayer && search->VoxelCollisionProfile.HasSameOffsets(data.VoxelCollisionProfile))
+		{
+			RepairRetainedSearch(*search, data.OriginVolume);
+			JoinCoalescedSearch(task, *retainedSearchId, *search);
+
+			UE_LOG(DoNNavigationLog, Verbose, TEXT("Repairing the retained search of %s (%d volumes reused)"), *data.GetActorName(), search->SettledVolumes.Num());
+
+			continue;
+		}
+
+		ReleaseRetainedSearch_Internal(owner);
+
+		// Keep memory bounded by dropping the least recently used search:
+		if (RetainedSearchIdByOwner.Num() >= MaxRetainedSearches)
+		{
+			AActor* leastRecentlyUsed = NULL;
+			double oldestTime = TNumericLimits<double>::Max();
+
+			for (const auto& retained : RetainedSearchIdByOwner)
+			{
+				const auto retainedSearch = CoalescedSearches.Find(retained.Value);
+				if (retainedSearch && retainedSearch->TimeLastUsed < oldestTime)
+				{
+					oldestTime = retainedSearch->TimeLastUsed;
+					leastRecentlyUsed = retained.Key;
+				}
+			}
+
+			ReleaseRetainedSearch_Internal(leastRecentlyUsed);
+		}
+
+		// Start a new goal-rooted search, directed at the owner:
+		FDonCoalescedSearch newSearch;
+		newSearch.GoalVolume = data.DestinationVolume;
+		newSearch.VoxelCollisionProfile = data.VoxelCollisionProfile;
+		newSearch.AgentSizeLayer = data.AgentSizeLayer;
+		newSearch.HeuristicTarget = data.OriginVolume;
+		newSearch.RetainedBy = owner;
+		newSearch.TimeLastUsed = FPlatformTime::Seconds();
+		newSearch.Frontier.put(newSearch.GoalVolume, 0);
+		newSearch.VolumeVsCostMap.Add(newSearch.GoalVolume, 0);
+
+		const int32 searchId = NextCoalescedSearchId++;
+		RetainedSearchIdByOwner.Add(owner, searchId);
+
+		JoinCoalescedSearch(task, searchId, CoalescedSearches.Add(searchId, MoveTemp(newSearch)));
+	}
+}
+
+void ADonNavigationManager::RepairRetainedSearch(FDonCoalescedSearch& Search, FDonNavigationVoxel* NewOrigin)
+{
+	Search.TimeLastUsed = FPlatformTime::Seconds();
+	Search.MemberOrigins.Reset();
+
+	if (Search.PendingBlockedVolumes.Num())
+	{
+		// 1. Which volumes of the search tree did the dynamic obstacles make impassable? (large agents are affected within their reach)
+		const int32 reach = AgentReachInVoxels(Search.VoxelCollisionProfile, Search.AgentSizeLayer);
+		TSet<FDonNavigationVoxel*> blockedVolumes;
+
+		for (auto pendingVolume : Search.PendingBlockedVolumes)
+		{
+			for (int32 x = pendingVolume->X - reach; x <= pendingVolume->X + reach; x++)
+				for (int32 y = pendingVolume->Y - reach; y <= pendingVolume->Y + reach; y++)
+					for (int32 z = pendingVolume->Z - reach; z <= pendingVolume->Z + reach; z++)
+					{
+						auto volume = VolumeAtSafe(x, y, z);
+						if (volume && volume != Search.GoalVolume && !blockedVolumes.Contains(volume) && Search.VolumeVsCostMap.Contains(volume) && !CanNavigateForAgent(volume, Search.VoxelCollisionProfile, Search.AgentSizeLayer))
+							blockedVolumes.Add(volume);
+					}
+		}
+
+		Search.PendingBlockedVolumes.Reset();
+
+		if (blockedVolumes.Num())
+		{
+			// 2. Every volume whose route to the goal runs through a blocked volume loses its cost (i.e. the blocked volumes' subtrees):
+			TMap<FDonNavigationVoxel*, bool> isInvalidated;
+			TArray<FDonNavigationVoxel*> chain;
+
+			for (const auto& link : Search.VolumeVsParentMap)
+			{
+				chain.Reset();
+
+				auto volume = link.Key;
+				bool bInvalidated = false;
+
+				while (true)
+				{
+					if (const bool* known = isInvalidated.Find(volume))
+					{
+						bInvalidated = *known;
+						break;
+					}
+
+					if (blockedVolumes.Contains(volume))
+					{
+						bInvalidated = true;
+						break;
+					}
+
+					if (volume == Search.GoalVolume)
+						break;
+
+					chain.Add(volume);
+
+					auto parent = Search.VolumeVsParentMap.Find(volume);
+					if (!parent || chain.Num() > Search.VolumeVsParentMap.Num())
+					{
+						bInvalidated = true;
+						break;
+					}
+
+					volume = *parent;
+				}
+
+				for (auto chainVolume : chain)
+					isInvalidated.Add(chainVolume, bInvalidated);
+			}
+
+			TArray<FDonNavigationVoxel*> removedVolumes = blockedVolumes.Array();
+			for (const auto& entry : isInvalidated)
+			{
+				if (entry.Value)
+					removedVolumes.Add(entry.Key);
+			}
+
+			for (auto volume : removedVolumes)
+			{
+				Search.VolumeVsCostMap.Remove(volume);
+				Search.VolumeVsParentMap.Remove(volume);
+				Search.SettledVolumes.Remove(volume);
+			}
+
+			// 3. Reseed the boundary: surviving volumes next to the hole are reopened so the search flows back into it
+			for (auto volume : removedVolumes)
+			{
+				const auto& neighbors = FindOrSetupNeighborsForVolume(volume);
+
+				for (auto neighbor : neighbors)
+				{
+					if (Search.VolumeVsCostMap.Contains(neighbor))
+						Search.SettledVolumes.Remove(neighbor);
+				}
+			}
+
+			UE_LOG(DoNNavigationLog, Verbose, TEXT("Retained search lost %d of %d volumes to dynamic collision"), removedVolumes.Num(), removedVolumes.Num() + Search.VolumeVsCostMap.Num());
+		}
+	}
+
+	Search.HeuristicTarget = NewOrigin;
+
+	if (Search.SettledVolumes.Contains(NewOrigin))
+		return; // nothing to solve, the path can be read off straight away
+
+	// Costs are measured from the goal and stay valid, but frontier priorities depend on where the owner now is, so the open set is requeued:
+	Search.Frontier = DoNNavigation::PriorityQueue<FDonNavigationVoxel*>();
+
+	for (const auto& entry : Search.VolumeVsCostMap)
+	{
+		if (!Search.SettledVolumes.Contains(entry.Key))
+			Search.Frontier.put(entry.Key, entry.Value + FVector::Dist(entry.Key->Location, NewOrigin->Location));
+	}
+}
+
+void ADonNavigationManager::NotifyRetainedSearches(const TArray<FDonNavigationVoxel*>& OccupiedVolumes)
+{
+	// Dynamic collision updates also run on the game thread while the retained searches belong to the solver thread,
+	// so the volumes are only queued here (see ApplyRetainedSearchNotifications)
+	if (OccupiedVolumes.Num())
+		RetainedSearchOccupiedVolumes.Enqueue(OccupiedVolumes);
+}
+
+void ADonNavigationManager::ApplyRetainedSearchNotifications()
+{
+	TArray<FDonNavigationVoxel*> occupiedVolumes;
+
+	while (RetainedSearchOccupiedVolumes.Dequeue(occupiedVolumes))
+	{
+		for (const auto& retained : RetainedSearchIdByOwner)
+		{
+			auto search = CoalescedSearches.Find(retained.Value);
+			if (!search)
+				continue;
+
+			// Only volumes the search has reached can invalidate it (large agents are re-tested within their reach when the repair happens)
+			const int32 reach = AgentReachInVoxels(search->VoxelCollisionProfile, search->AgentSizeLayer);
+
+			for (auto volume : occupiedVolumes)
+			{
+				if (reach || search->VolumeVsCostMap.Contains(volume))
+					search->PendingBlockedVolumes.Add(volume);
+			}
+		}
+	}
+}
+
+void ADonNavigationManager::ReleaseRetainedSearch_Internal(AActor* Actor)
+{
+	int32 searchId = INDEX_NONE;
+	if (!Actor || !RetainedSearchIdByOwner.RemoveAndCopyValue(Actor, searchId))
+		return;
+
+	// A query that is still using the search keeps it alive until it completes (see ReleaseIdleCoalescedSearches)
+	auto search = CoalescedSearches.Find(searchId);
+	if (search)
+		search->RetainedBy = NULL;
+}
+
+void ADonNavigationManager::TickScheduledPathfindingTasks(float DeltaSeconds, int32 MaxIterationsPerTick, double TimeBudgetSeconds)
+{
+	// (drained even when idle, so the queue can't build up between queries)
+	ApplyRetainedSearchNotifications();
+
+	const int32 numTasks = ActiveNavigationTasks.Num();
+
+	if (!numTasks)
+		return;
+
+	if (!bIsUnbound)
+		AttachRetainedSearches();
+
+	if (bCoalesceSharedDestinationQueries && !bIsUnbound)
+		CoalesceNewPathfindingTasks();
+
+	const double now = FPlatformTime::Seconds();
+
+	// Service order: by scheduling weight (priority class, aging and deadline urgency folded into one score)
+	TArray<float> weights;
+	TArray<int32> serviceOrder;
+	weights.SetNumUninitialized(numTasks);
+	serviceOrder.SetNumUninitialized(numTasks);
+
+	for (int32 i = 0; i < numTasks; i++)
+	{
+		weights[i] = SchedulingWeight(ActiveNavigationTasks[i]->Data, now);
+		serviceOrder[i] = i;
+	}
+
+	serviceOrder.Sort([&weights](int32 A, int32 B)
+	{
+		return weights[A] > weights[B];
+	});
+
+	// With more tasks than iterations, only the first in service order get one iteration each this tick.
+	// Otherwise every task gets a share of the budget in proportion to its weight:
+	const bool bTimeBudgeted = TimeBudgetSeconds > 0.0;
+	const int32 numTasksThisTick = bTimeBudgeted ? numTasks : FMath::Min(numTasks, MaxIterationsPerTick);
+
+	float totalWeight = 0.f;
+	for (int32 k = 0; k < numTasksThisTick; k++)
+		totalWeight += weights[serviceOrder[k]];
+
+	TArray<int32> completedTasks;
+
+	for (int32 k = 0; k < numTasksThisTick; k++)
 	{
 		//SCOPE_CYCLE_COUNTER(STAT_PathfindingSolver);
 
-		auto& task = ActiveNavigationTasks[i];
+		// Time budget spent? The remaining tasks wait for the next tick (aging moves them up the service order)
+		if (bTimeBudgeted && k > 0 && FPlatformTime::Seconds() - now >= TimeBudgetSeconds)
+			break;
+
+		const int32 i = serviceOrder[k];
+		const float share = weights[i] / totalWeight;
+
+		auto& task = *ActiveNavigationTasks[i];
 		auto& data = task.Data;
 
+		const int32 iterationShare = numTasks <= MaxIterationsPerTick ? FMath::Max(FMath::FloorToInt(MaxIterationsPerTick * share), 1) : 1;
+		const int32 maxIterationsPerTask = bTimeBudgeted ? IterationQuantumForTimeBudget(data, TimeBudgetSeconds * share, iterationShare) : iterationShare;
+
+		// Time is measured with the monotonic high resolution clock on both the game and worker threads (the worker has no frame delta time)
+		const double taskStartTime = FPlatformTime::Seconds();
+
+		if (data.TimeFirstServiced <= 0.0)
+		{
+			data.TimeFirstServiced = taskStartTime;
+			data.QueueWaitTime = (float)(taskStartTime - data.TimeScheduled);
+		}
+
+		data.SolverTimeTaken = (float)(taskStartTime - data.TimeFirstServiced);
+
+		// Has this path been solved before? (only checked before the solver has spent any effort on the query)
+		if (!data.SolverIterationCount && ServeFromPathCache(task))
+		{
+			UE_LOG(DoNNavigationLog, Verbose, TEXT("Query for %s, %s served from the path cache (hit rate %f)"), *data.GetActorName(), *data.Destination.ToString(), GetPathCacheHitRate());
+		}
 		// Query timeout?
-		if (data.SolverTimeTaken >= data.QueryParams.QueryTimeout)
+		else if (data.SolverTimeTaken >= data.QueryParams.QueryTimeout)
 		{
 			// Do we at least have the unoptimized solution ready yet? If yes, simply return it! The unoptimized solution is perfectly usable for navigation.
-			if (data.bGoalFound && !data.bGoalOptimized)
+			// (anytime queries always have one once their first path is published: PathSolutionRaw holds the best path found so far)
+			if ((data.bGoalFound || data.bHasAnytimeSolution) && !data.bGoalOptimized)
 			{
 				UE_LOG(DoNNavigationLog, Warning, TEXT("Query timed out before optimization was complete, returning unoptimized solution for Actor %s. Num iterations : %d"), *data.GetActorName(), data.SolverIterationCount);
 				
@@ -2650,82 +4504,305 @@ void ADonNavigationManager::TickScheduledPathfindingTasks(float DeltaSeconds, in
 
 				data.QueryStatus = EDonNavigationQueryStatus::Success;
 			}			
+			else if (data.QueryParams.bAllowPartialPath && PackagePartialSolution(task))
+			{
+				UE_LOG(DoNNavigationLog, Warning, TEXT("Query timed out for Actor %s, returning a partial path. Num iterations : %d"), *data.GetActorName(), data.SolverIterationCount);
+			}
 			else
 			{
 				UE_LOG(DoNNavigationLog, Error, TEXT("Query timed out for Actor %s. Num iterations : %d"), *data.GetActorName(), data.SolverIterationCount);
 
 				data.QueryStatus = EDonNavigationQueryStatus::TimedOut;
 
-			#if WITH_EDITOR
-				DrawDebugSphere_Safe(GetWorld(), data.Destination, 15.f, 8.f, FColor::Red, true, 15.f);
-			#endif
-			}
-		}
-		else
-		{
-			int32 iterationsProcessed = 1;
+			#if WITH_EDITOR
+				DrawDebugSphere_Safe(GetWorld(), data.Destination, 15.f, 8.f, FColor::Red, true, 15.f);
+			#endif
+			}
+		}
+		else
+		{
+			int32 iterationsProcessed = 1;
+
+			if (data.QueryParams.bUseSearchCorridor && !data.SearchCorridorExpansions.Num() && data.CoalescedSearchId == INDEX_NONE)
+				BeginSearchCorridorAttempt(data);
+
+			// Core pathfinding algorithm
+			if (data.CoalescedSearchId != INDEX_NONE)
+			{
+				if (!data.bGoalFound)
+					TickCoalescedQuery(task, iterationsProcessed, maxIterationsPerTask);
+			}
+			else
+			{
+				while (!data.bGoalFound && iterationsProcessed <= maxIterationsPerTask)
+				{
+					TickNavigationSolver(task);
+					iterationsProcessed++;
+				}
+			}
+
+			data.SolveTime += (float)(FPlatformTime::Seconds() - taskStartTime);
+
+			// Anytime query with an inflated heuristic? Publish what we have and keep refining
+			if (data.bGoalFound && data.HeuristicWeight > 1.f && !bIsUnbound && data.CoalescedSearchId == INDEX_NONE)
+			{
+				PublishAnytimeSolution(task);
+				BeginAnytimeRefinement(task);
+			}
+
+			// Is pathfinding complete?
+			if (data.bGoalFound)
+			{
+				const double optimizeStartTime = FPlatformTime::Seconds();
+
+				TickNavigationOptimizerCycle(task, iterationsProcessed, maxIterationsPerTask);
+
+				data.OptimizeTime += (float)(FPlatformTime::Seconds() - optimizeStartTime);
+			}
+			// Refinement ran out of volumes to improve, the best published path is final:
+			else if (data.Frontier.empty() && data.bHasAnytimeSolution)
+			{
+				PackageRawSolution(task);
+
+				VisualizeSolution(data.Origin, data.Destination, data.PathSolutionRaw, data.PathSolutionOptimized, data.DebugParams);
+
+				data.QueryStatus = EDonNavigationQueryStatus::Success;
+			}
+			// Nothing left inside the search corridor? Try again with a wider one
+			else if (data.Frontier.empty() && data.Frontier_Unbound.empty() && WidenSearchCorridor(task))
+			{
+				// (the solver resumes from the explored volumes on the next tick)
+			}
+			// Or path has no solution?
+			else if (data.Frontier.empty() && data.Frontier_Unbound.empty() && data.QueryParams.bAllowPartialPath && PackagePartialSolution(task))
+			{
+				UE_LOG(DoNNavigationLog, Warning, TEXT("No pathfinding solution exists for query %s, %s. Returning a partial path"), *data.GetActorName(), *data.Destination.ToString());
+			}
+			else if (data.Frontier.empty() && data.Frontier_Unbound.empty())
+			{
+				UE_LOG(DoNNavigationLog, Error, TEXT("No pathfinding solution exists for query %s, %s"), *data.GetActorName(), *data.Destination.ToString());
+
+				data.QueryStatus = EDonNavigationQueryStatus::QueryHasNoSolution;
+
+				#if WITH_EDITOR
+					DrawDebugSphere_Safe(GetWorld(), data.Destination, 15.f, 8.f, FColor::Red, true, 15.f);
+				#endif
+			}
+
+			if (iterationsProcessed > 1)
+				UpdateSolverCostEstimate(data, FPlatformTime::Seconds() - taskStartTime, iterationsProcessed - 1);
+		}
+		
+		if (task.IsQueryComplete())
+		{	
+			if (data.QueryStatus == EDonNavigationQueryStatus::Success && data.bGoalOptimized && !data.bServedFromPathCache)
+				AddToPathCache(task);
+
+			RecordQueueTimeStats(data, FPlatformTime::Seconds());
+
+			completedTasks.Add(i);
+		}
+	}
+
+	// Highest index first: completing a task swaps the last task into its slot
+	completedTasks.Sort(TGreater<int32>());
+
+	for (int32 i : completedTasks)
+		CompleteNavigationTask(i);
+
+	ReleaseIdleCoalescedSearches();
+
+	// Single-threaded: notify owners only now that the task list is no longer being iterated (handlers may schedule or abort queries)
+	if (PendingSynchronousResults.Num())
+	{
+		auto results = MoveTemp(PendingSynchronousResults);
+		PendingSynchronousResults.Reset();
+
+		for (auto result : results)
+		{
+			result->BroadcastResult();
+			QueryTaskPool.Release(result);
+		}
+	}
+}
+
+float ADonNavigationManager::SchedulingWeight(const FDoNNavigationQueryData& Data, double Now) const
+{
+	const uint8 priorityClass = FMath::Min((uint8)Data.QueryParams.Priority, (uint8)((uint8)EDonNavigationQueryPriority::Num - 1));
+	const float classWeight = (float)(1 << priorityClass);
+
+	// Aging: every PriorityAgingTime spent waiting adds another class weight
+	const float waitingTime = (float)(Now - Data.TimeScheduled);
+	const float aging = PriorityAgingTime > 0.f ? FMath::Max(waitingTime, 0.f) / PriorityAgingTime : 0.f;
+
+	float weight = classWeight * (1.f + aging);
+
+	// Deadline urgency: a bounded boost growing as the slack left runs out, so aging keeps everyone else from starving. Past due queries get none
+	if (Data.HasDeadline())
+	{
+		const float slack = (float)(Data.AbsoluteDeadline() - Now);
+
+		if (slack > 0.f)
+			weight *= 1.f + FMath::Max(DeadlineUrgencyBoost, 0.f) * (1.f - FMath::Clamp(slack / Data.QueryParams.Deadline, 0.f, 1.f));
+	}
+
+	return weight;
+}
+
+int32 ADonNavigationManager::IterationQuantumForTimeBudget(const FDoNNavigationQueryData& Data, double TimeBudgetSeconds, int32 FallbackIterations) const
+{
+	const double secondsPerIteration = Data.SecondsPerIteration > 0.0 ? Data.SecondsPerIteration : SolverSecondsPerIteration;
+
+	// Nothing measured yet, fall back to the iteration budget:
+	if (secondsPerIteration <= 0.0)
+		return FallbackIterations;
+
+	return FMath::Clamp(FMath::FloorToInt(TimeBudgetSeconds / secondsPerIteration), 1, MAX_int32 / 2);
+}
+
+void ADonNavigationManager::UpdateSolverCostEstimate(FDoNNavigationQueryData& Data, double SecondsTaken, int32 Iterations)
+{
+	const double smoothing = 0.25;
+	const double secondsPerIteration = SecondsTaken / Iterations;
+
+	Data.SecondsPerIteration = Data.SecondsPerIteration > 0.0 ? FMath::Lerp(Data.SecondsPerIteration, secondsPerIteration, smoothing) : secondsPerIteration;
+	SolverSecondsPerIteration = SolverSecondsPerIteration > 0.0 ? FMath::Lerp(SolverSecondsPerIteration, secondsPerIteration, smoothing) : secondsPerIteration;
+}
+
+void ADonNavigationManager::RecordQueueTimeStats(const FDoNNavigationQueryData& Data, double Now)
+{
+	const uint8 priorityClass = FMath::Min((uint8)Data.QueryParams.Priority, (uint8)((uint8)EDonNavigationQueryPriority::Num - 1));
+	const double queueTime = FMath::Max(Data.TimeFirstServiced - Data.TimeScheduled, 0.0);
+
+	FScopeLock lock(&QueueTimeStatsLock);
+
+	auto& stats = QueueTimeStats[priorityClass];
+	stats.NumQueries++;
+	stats.TotalQueueTime += queueTime;
+	stats.MaxQueueTime = FMath::Max(stats.MaxQueueTime, queueTime);
+	stats.TotalTimeToComplete += Now - Data.TimeScheduled;
+
+	if (Data.HasDeadline() && Now > Data.AbsoluteDeadline())
+		stats.DeadlinesMissed++;
+}
+
+void ADonNavigationManager::GetQueueTimeStats(EDonNavigationQueryPriority PriorityClass, int32& NumQueries, float& AverageQueueTime, float& MaxQueueTime, float& AverageTimeToComplete, int32& DeadlinesMissed)
+{
+	NumQueries = DeadlinesMissed = 0;
+	AverageQueueTime = MaxQueueTime = AverageTimeToComplete = 0.f;
+
+	if (PriorityClass >= EDonNavigationQueryPriority::Num)
+		return;
+
+	FScopeLock lock(&QueueTimeStatsLock);
+
+	const auto& stats = QueueTimeStats[(uint8)PriorityClass];
+	NumQueries = stats.NumQueries;
+	DeadlinesMissed = stats.DeadlinesMissed;
+	MaxQueueTime = stats.MaxQueueTime;
+
+	if (stats.NumQueries)
+	{
+		AverageQueueTime = stats.TotalQueueTime / stats.NumQueries;
+		AverageTimeToComplete = stats.TotalTimeToComplete / stats.NumQueries;
+	}
+}
+
+void ADonNavigationManager::ResetQueueTimeStats()
+{
+	FScopeLock lock(&QueueTimeStatsLock);
+
+	for (auto& stats : QueueTimeStats)
+		stats = FDonQueueTimeStats();
+}
+
+void ADonNavigationManager::PublishAnytimeSolution(FDonNavigationQueryTask& Task)
+{
+	auto& data = Task.Data;
+
+	data.VolumeSolution.Reset();
+	data.PathSolutionRaw.Reset();
+
+	if (!PrepareSolution(Task))
+		return;
+
+	data.bHasAnytimeSolution = true;
+
+	UE_LOG(DoNNavigationLog, Verbose, TEXT("Anytime query for %s found a path with heuristic weight %f in %d iterations, refining..."), *data.GetActorName(), data.HeuristicWeight, data.SolverIterationCount);
+
+	auto result = QueryTaskPool.Acquire();
+	*result = Task.CopyForResult();
+	result->Data.PathSolutionOptimized = data.PathSolutionRaw;
+	result->Data.QueryStatus = EDonNavigationQueryStatus::Success;
+	result->Data.bIsFinalResult = false;
+
+	if (bMultiThreadingEnabled)
+		CompletedNavigationTasks.Enqueue(result);
+	else
+		PendingSynchronousResults.Add(result);
+}
+
+void ADonNavigationManager::BeginAnytimeRefinement(FDonNavigationQueryTask& Task)
+{
+	auto& data = Task.Data;
 
-			// Core pathfinding algorithm
-			while (!data.bGoalFound && iterationsProcessed <= maxIterationsPerTask)
-			{
-				TickNavigationSolver(task);
-				iterationsProcessed++;
-			}
+	data.HeuristicWeight = FMath::Max(data.HeuristicWeight - data.QueryParams.AnytimeWeightDecrement, 1.f);
+	data.bGoalFound = false;
 
-			data.SolverTimeTaken += DeltaSeconds;
+	// Re-prioritize the open volumes (and those improved after being closed) with the new weight. The goal goes back in as well:
+	// it is accepted again once nothing cheaper is left in the open list.
+	TSet<FDonNavigationVoxel*> openVolumes = MoveTemp(data.AnytimeInconsistentVolumes);
+	openVolumes.Add(data.DestinationVolume);
 
-			// Is pathfinding complete?
-			if (data.bGoalFound)
-			{
-				TickNavigationOptimizerCycle(task, iterationsProcessed, maxIterationsPerTask);
-			}
-			// Or path has no solution?
-			else if (data.Frontier.empty() && data.Frontier_Unbound.empty())
-			{
-				UE_LOG(DoNNavigationLog, Error, TEXT("No pathfinding solution exists for query %s, %s"), *data.GetActorName(), *data.Destination.ToString());
+	while (!data.Frontier.empty())
+		openVolumes.Add(data.Frontier.get());
 
-				data.QueryStatus = EDonNavigationQueryStatus::QueryHasNoSolution;
+	for (auto volume : openVolumes)
+	{
+		const uint32* cost = data.VolumeVsCostMap.Find(volume);
+		if (!cost)
+			continue;
 
-				#if WITH_EDITOR
-					DrawDebugSphere_Safe(GetWorld(), data.Destination, 15.f, 8.f, FColor::Red, true, 15.f);
-				#endif
-			}
-		}
-		
-		if (task.IsQueryComplete())
-		{	
-			CompleteNavigationTask(i);
-		}
+		float heuristic = FVector::Dist(volume->Location, data.Destination);
+		data.Frontier.put(volume, *cost + heuristic * data.HeuristicWeight);
 	}
+
+	data.AnytimeClosedVolumes.Reset();
+	data.AnytimeInconsistentVolumes.Reset();
 }
 
-void ADonNavigationManager::TickScheduledPathfindingTasks_Safe(float DeltaSeconds, int32 MaxIterationsPerTick)
+void ADonNavigationManager::TickScheduledPathfindingTasks_Safe(float DeltaSeconds, int32 MaxIterationsPerTick, double TimeBudgetSeconds)
 {
-	TickScheduledPathfindingTasks(DeltaSeconds, MaxIterationsPerTick);
+	TickScheduledPathfindingTasks(DeltaSeconds, MaxIterationsPerTick, TimeBudgetSeconds);
 }
 
 void ADonNavigationManager::CompleteNavigationTask(int32 TaskIndex)
 {
 	bool bSynchronousOperation = !bMultiThreadingEnabled;
 
+	// The search state is no longer needed, recycle it right away rather than shipping it along with the result:
+	auto& data = ActiveNavigationTasks[TaskIndex]->Data;
+	data.ReleaseSolverState();
+
+	if (data.QueryParams.bBuildPathSpline)
+		BuildPathSpline(data);
+
+	data.BuildResult();
+
 	if (bSynchronousOperation)
 	{
 		// During synchronous calls the delegate owner is capable of internally launching of a new query that will check for the existing task when we execute the delegate.
-		// Therefore, to ensure deterministic behavior we first remove the task and only _then_ launch the delegte on a safe copy:
+		// Therefore, to ensure deterministic behavior we first remove the task and only _then_ launch the delegte on a safe copy.
+		// (the owner is notified at the end of the tick, once all completed tasks have been removed)
 
-		auto task_safecopy = ActiveNavigationTasks[TaskIndex];
+		PendingSynchronousResults.Add(ActiveNavigationTasks[TaskIndex]);
 
 		// Remove this task
 		ActiveNavigationTasks.RemoveAtSwap(TaskIndex);
-
-		// Notify owner
-		task_safecopy.ResultHandler.ExecuteIfBound(task_safecopy.Data);
-
-
 	}
 	else
 	{
-		auto owner = ActiveNavigationTasks[TaskIndex].Data.Actor.Get();
+		auto owner = ActiveNavigationTasks[TaskIndex]->Data.Actor.Get();
 
 		CompletedNavigationTasks.Enqueue(ActiveNavigationTasks[TaskIndex]);
 		ActiveNavigationTasks.RemoveAtSwap(TaskIndex);
@@ -2737,6 +4814,56 @@ void ADonNavigationManager::CompleteNavigationTask(int32 TaskIndex)
 
 }
 
+void ADonNavigationManager::BuildPathSpline(FDoNNavigationQueryData& Data)
+{
+	Data.PathSpline.Reset();
+
+	if (Data.PathSolutionOptimized.Num() < 3)
+		return; // nothing to smooth
+
+	auto spline = MakeShared<FDonNavigationPathSpline, ESPMode::ThreadSafe>();
+
+	if (bIsUnbound)
+	{
+		UPrimitiveComponent* collisionComponent = Data.CollisionComponent.Get();
+		if (!collisionComponent)
+			return;
+
+		const float inflation = Data.QueryParams.CollisionShapeInflation;
+
+		spline->Build(Data.PathSolutionOptimized, Data.QueryParams.PathSplineSamplesPerSegment, [this, collisionComponent, inflation](const FVector& Start, const FVector& End)
+		{
+			FHitResult hit;
+			return IsDirectPathLineSweep(collisionComponent, Start, End, hit, false, inflation);
+		});
+	}
+	else
+	{
+		spline->Build(Data.PathSolutionOptimized, Data.QueryParams.PathSplineSamplesPerSegment, [this, &Data](const FVector& Start, const FVector& End)
+		{
+			return ForEachVoxelAlongSegment(Start, End, [this, &Data](FDonNavigationVoxel* Volume)
+			{
+				return Volume && CanNavigateForQuery(Volume, Data);
+			});
+		});
+	}
+
+	if (!spline->IsValid())
+		return;
+
+	if (spline->GetNumStraightenedSpans())
+		UE_LOG(DoNNavigationLog, Verbose, TEXT("Path spline for %s: %d of %d segments kept straight to avoid collisions"), *Data.GetActorName(), spline->GetNumStraightenedSpans(), Data.PathSolutionOptimized.Num() - 1);
+
+	if (Data.DebugParams.VisualizeOptimizedPath)
+	{
+		const auto& samples = spline->GetSamples();
+		for (int32 i = 1; i < samples.Num(); i++)
+			DrawDebugLine_Safe(GetWorld(), samples[i - 1], samples[i], FColor::Cyan, Data.DebugParams.LineDuration < 0, Data.DebugParams.LineDuration, 0.f, Data.DebugParams.LineThickness);
+	}
+
+	Data.PathSpline = spline;
+}
+
 bool ADonNavigationManager::PrepareSolution(FDonNavigationQueryTask& Task)
 {
 	auto& data = Task.Data;
@@ -2746,6 +4873,115 @@ bool ADonNavigationManager::PrepareSolution(FDonNavigationQueryTask& Task)
 	return bGoalFound;
 }
 
+void ADonNavigationManager::BeginSearchCorridorAttempt(FDoNNavigationQueryData& Data)
+{
+	const int32 attempt = Data.SearchCorridorExpansions.Num();
+	Data.SearchCorridorExpansions.Add(0);
+
+	Data.SearchCorridorFocusA = bIsUnbound ? FVector(Data.OriginVolumeCenter) : Data.OriginVolume->Location;
+	Data.SearchCorridorFocusB = bIsUnbound ? FVector(Data.DestinationVolumeCenter) : Data.DestinationVolume->Location;
+
+	// Past the last configured corridor the search is unbounded:
+	if (!Data.QueryParams.SearchCorridorScales.IsValidIndex(attempt))
+	{
+		Data.SearchCorridorMaxDistSum = 0.f;
+		return;
+	}
+
+	const float focalDistance = FVector::Dist(Data.SearchCorridorFocusA, Data.SearchCorridorFocusB);
+	const float padding = Data.QueryParams.SearchCorridorPaddingVoxels * VoxelSize;
+
+	Data.SearchCorridorMaxDistSum = FMath::Max(Data.QueryParams.SearchCorridorScales[attempt], 1.f) * focalDistance + 2.f * padding;
+}
+
+bool ADonNavigationManager::WidenSearchCorridor(FDonNavigationQueryTask& Task)
+{
+	auto& data = Task.Data;
+
+	if (data.SearchCorridorMaxDistSum <= 0.f)
+		return false;
+
+	UE_LOG(DoNNavigationLog, Verbose, TEXT("Query for %s found no path inside search corridor %d (%d nodes expanded), widening..."), *data.GetActorName(), data.SearchCorridorExpansions.Num() - 1, data.SearchCorridorExpansions.Last());
+
+	BeginSearchCorridorAttempt(data);
+
+	// Resume from everything explored so far rather than starting over. Only volumes on the old corridor's boundary can reach the newly opened space,
+	// the interior has nothing left to expand into:
+	for (auto volume : data.SearchCorridorBoundary)
+	{
+		const uint32* cost = data.VolumeVsCostMap.Find(volume);
+		if (!cost)
+			continue;
+
+		const float heuristic = FVector::Dist(volume->Location, data.Destination);
+		data.Frontier.put(volume, *cost + heuristic * data.HeuristicWeight);
+	}
+
+	for (const auto& location : data.SearchCorridorBoundary_Unbound)
+	{
+		const uint32* cost = data.VolumeVsCostMap_Unbound.Find(location);
+		if (!cost)
+			continue;
+
+		const float heuristic = FVector::Dist(location, data.Destination);
+		data.Frontier_Unbound.put(location, *cost + heuristic * data.HeuristicWeight);
+	}
+
+	data.SearchCorridorBoundary.Reset();
+	data.SearchCorridorBoundary_Unbound.Reset();
+
+	data.AnytimeClosedVolumes.Reset();
+	data.LazyThetaClosedVolumes.Reset();
+
+	return true;
+}
+
+bool ADonNavigationManager::PreparePartialSolution(FDonNavigationQueryTask& Task)
+{
+	auto& data = Task.Data;
+
+	if (!data.OriginVolume)
+		return false;
+
+	// Find the explored volume nearest to the destination (lowest heuristic). It must be closer than where we started from, or there is no progress to be made:
+	FDonNavigationVoxel* nearestVolume = NULL;
+	float nearestDistSq = FVector::DistSquared(data.OriginVolume->Location, data.Destination);
+
+	for (const auto& entry : data.VolumeVsCostMap)
+	{
+		const float distSq = FVector::DistSquared(entry.Key->Location, data.Destination);
+		if (distSq < nearestDistSq)
+		{
+			nearestDistSq = distSq;
+			nearestVolume = entry.Key;
+		}
+	}
+
+	if (!nearestVolume)
+		return false;
+
+	data.VolumeSolution.Reset();
+	data.PathSolutionRaw.Reset();
+
+	return PathSolutionFromVolumeTrajectoryMap(data.OriginVolume, nearestVolume, data.VolumeVsGoalTrajectoryMap, data.VolumeSolution, data.PathSolutionRaw, data.Origin, nearestVolume->Location, data.DebugParams);
+}
+
+bool ADonNavigationManager::PackagePartialSolution(FDonNavigationQueryTask& Task)
+{
+	auto& data = Task.Data;
+
+	if (!PreparePartialSolution(Task) || !data.PathSolutionRaw.Num())
+		return false;
+
+	PackageRawSolution(Task);
+
+	VisualizeSolution(data.Origin, data.PathSolutionRaw.Last(), data.PathSolutionRaw, data.PathSolutionOptimized, data.DebugParams);
+
+	data.QueryStatus = EDonNavigationQueryStatus::PartialSuccess;
+
+	return true;
+}
+
 void ADonNavigationManager::TickNavigationOptimizerCycle(FDonNavigationQueryTask& task, int32& IterationsProcessed, const int32 MaxIterationsPerTask)
 {
 	auto& data = task.Data;
@@ -2754,7 +4990,15 @@ void ADonNavigationManager::TickNavigationOptimizerCycle(FDonNavigationQueryTask
 
 	if (!data.bOptimizationInProgress)
 	{
-		data.bGoalFound = PrepareSolution(task);
+		// Anytime queries have already prepared a provisional solution, start over with the refined search
+		if (data.bHasAnytimeSolution)
+		{
+			data.VolumeSolution.Reset();
+			data.PathSolutionRaw.Reset();
+		}
+
+		// Coalesced queries already have their solution, read off the shared search
+		data.bGoalFound = data.bSolutionFromCoalescedSearch || PrepareSolution(task);
 
 		if(!data.bGoalFound)
 		{
@@ -2769,7 +5013,7 @@ void ADonNavigationManager::TickNavigationOptimizerCycle(FDonNavigationQueryTask
 			return;
 		}
 
-		bool startOptimizer = !data.QueryParams.bSkipOptimizationPass;
+		bool startOptimizer = !data.QueryParams.bSkipOptimizationPass && (!data.UsesLazyThetaStar() || bIsUnbound || data.QueryParams.bOptimizeAnyAnglePath);
 
 		if (startOptimizer)
 			data.BeginOptimizationCycle();
@@ -2806,11 +5050,7 @@ void ADonNavigationManager::TickNavigationOptimizerCycle(FDonNavigationQueryTask
 	if (data.bGoalOptimized)
 	{
 		// Add dynamic collision listeners
-		if (!bIsUnbound)
-		{
-			for (auto volume : data.VolumeSolutionOptimized)
-				AddCollisionListenerToVolumeFromTask(volume, task);
-		}
+		SubscribeToDynamicCollisions(task);
 
 		VisualizeSolution(data.Origin, data.Destination, data.PathSolutionRaw, data.PathSolutionOptimized, data.DebugParams);
 
@@ -2842,17 +5082,47 @@ void ADonNavigationManager::TickNavigationOptimizer(FDonNavigationQueryTask& tas
 
 	// Tight-loop equivalent (provided just for clarity): 
 	//for (int32 optimizer_j = PathSolution.Num() - 1; j > i; j--)
+	// Each call tests a batch of the next candidates for j at once, furthest first.
 
-	FHitResult OutHit;
-	TArray<AActor*> actorsToIgnore;
-	
 	const bool bConsiderInitialOverlaps = true;	
 	FVector start = data.PathSolutionRaw[data.optimizer_i];
-	FVector end = data.PathSolutionRaw[data.optimizer_j];
+
+	// Shortcuts crossing a voxel known to be occupied are skipped without a sweep:
+	const bool bGridLineOfSight = bOptimizerGridLineOfSight && !bIsUnbound;
+	const int32 batchSize = FMath::Clamp(OptimizerSweepBatchSize, 1, 64);
+
+	TArray<int32, TInlineAllocator<64>> candidates;
+
+	while (candidates.Num() < batchSize && data.optimizer_j > data.optimizer_i && !data.MaxSweepAttemptsReachedForNode())
+	{
+		if (!bGridLineOfSight || IsGridLineOfSightClear(start, data.PathSolutionRaw[data.optimizer_j]))
+			candidates.Add(data.optimizer_j);
+
+		data.optimizer_j--;
+	}
+
+	// Confirm the candidates with physics sweeps, in parallel:
+	TArray<bool, TInlineAllocator<64>> directPaths;
+	directPaths.SetNumZeroed(candidates.Num());
+
+	UPrimitiveComponent* collisionComponent = data.CollisionComponent.Get();
+	const float collisionShapeInflation = data.QueryParams.CollisionShapeInflation;
+
+	ParallelFor(candidates.Num(), [&](int32 k)
+	{
+		FHitResult OutHit;
+		directPaths[k] = IsDirectPathLineSweep(collisionComponent, start, data.PathSolutionRaw[candidates[k]], OutHit, bConsiderInitialOverlaps, collisionShapeInflation);
+	}, candidates.Num() < 2 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	// The furthest candidate with a direct path wins, exactly as if the candidates had been swept one after the other:
+	const int32 directPathIndex = directPaths.Find(true);
 	
 	// Do we see a direct path from start to end?
-	if (IsDirectPathLineSweep(data.CollisionComponent.Get(), start, end, OutHit, bConsiderInitialOverlaps, task.Data.QueryParams.CollisionShapeInflation))
+	if (directPathIndex != INDEX_NONE)
 	{
+		data.optimizer_j = candidates[directPathIndex];
+		FVector end = data.PathSolutionRaw[data.optimizer_j];
+
 		data.PathSolutionOptimized.Add(data.PathSolutionRaw[data.optimizer_j]);		
 
 		// Optimizer has reached the goal?
@@ -2875,9 +5145,6 @@ void ADonNavigationManager::TickNavigationOptimizer(FDonNavigationQueryTask& tas
 	}
 	else
 	{
-		// Try forging a direct path to the next available node:
-		data.optimizer_j--;
-
 		// Are all possible optimization paths exhausted for this node?
 		if (data.optimizer_j == data.optimizer_i || data.MaxSweepAttemptsReachedForNode())
 		{	
@@ -2893,42 +5160,215 @@ void ADonNavigationManager::TickNavigationOptimizer(FDonNavigationQueryTask& tas
 	}
 }
 
+/** Optimizer prefilter: only voxels already known to be occupied block, so this never rules out a line a physics sweep would accept on account of missing data.
+*   The end points' own voxels are skipped: flexible origins and goals are kept exactly where they were asked for, which may well be inside an occupied voxel.
+*/
+bool ADonNavigationManager::IsGridLineOfSightClear(const FVector& Start, const FVector& End)
+{
+	const FDonNavigationVoxel* startVolume = VolumeAt(Start);
+	const FDonNavigationVoxel* endVolume = VolumeAt(End);
+
+	return ForEachVoxelAlongSegment(Start, End, [startVolume, endVolume](FDonNavigationVoxel* Volume)
+	{
+		return !Volume || Volume == startVolume || Volume == endVolume || !Volume->bIsInitialized || Volume->CanNavigate();
+	});
+}
+
 // Dynamic Collision Listeners
-void ADonNavigationManager::AddCollisionListenerToVolumeFromTask(FDonNavigationVoxel* Volume, FDonNavigationQueryTask& task)
+void ADonNavigationManager::MapPathPointsToVolumes(FDoNNavigationQueryData& Data)
+{
+	// The volume list holds every voxel crossed between the path's points (see AppendVolumeListFromRange), in path order. Each point begins at the first
+	// occurrence of its own voxel past the previous point. A point whose voxel isn't listed (eg: the destination of a direct path) begins where the previous one did.
+	const auto& volumes = Data.VolumeSolutionOptimized;
+	const auto& path = Data.PathSolutionOptimized;
+
+	Data.PathPointVolumeIndices.Reset(path.Num());
+
+	int32 cursor = 0;
+
+	for (const FVector& point : path)
+	{
+		const FDonNavigationVoxel* pointVolume = VolumeAt(point);
+
+		for (int32 i = cursor; i < volumes.Num(); i++)
+		{
+			if (volumes[i] == pointVolume)
+			{
+				cursor = i;
+				break;
+			}
+		}
+
+		Data.PathPointVolumeIndices.Add(cursor);
+	}
+}
+
+void ADonNavigationManager::SubscribeToDynamicCollisions(FDonNavigationQueryTask& Task)
 {
-	if (!Volume || !task.DynamicCollisionListener.IsBound())
+	auto& data = Task.Data;
+
+	if (bIsUnbound || !Task.DynamicCollisionListener.IsBound() || !data.VolumeSolutionOptimized.Num())
 		return;
 
-	auto listener = task.DynamicCollisionListener;
-	auto payload = FDonNavigationDynamicCollisionPayload(task.Data.QueryParams.CustomDelegatePayload, *Volume);
-	auto notifyee = FDonNavigationDynamicCollisionNotifyee(listener, payload);
+	MapPathPointsToVolumes(data);
+
+	// Gather the watched voxels before taking the lock:
+	const bool bPreciseDynamicCollisionRepathing = data.QueryParams.bPreciseDynamicCollisionRepathing;
+	const auto& offsets = data.VoxelCollisionProfile.Offsets();
+
+	TArray<int32> voxelIds;
+	voxelIds.Reserve(data.VolumeSolutionOptimized.Num() * (bPreciseDynamicCollisionRepathing ? offsets.Num() + 1 : 1));
+
+	for (auto volume : data.VolumeSolutionOptimized)
+	{
+		if (!volume)
+			continue;
+
+		voxelIds.Add(VoxelIdFor(volume));
+
+		if (bPreciseDynamicCollisionRepathing)
+		{
+			for (const auto& offset : offsets)
+			{
+				auto volumeFromProfile = VolumeAtSafe(volume->X + offset.X, volume->Y + offset.Y, volume->Z + offset.Z);
+				if (volumeFromProfile)
+					voxelIds.Add(VoxelIdFor(volumeFromProfile));
+			}
+		}
+	}
+
+	// Neighbouring path voxels share most of the space around them:
+	voxelIds.Sort();
+	voxelIds.SetNum(Algo::Unique(voxelIds), EAllowShrinking::No);
+
+	FScopeLock lock(&CollisionSubscriptionLock);
+
+	// A query which packages its path more than once (eg: raw solution, then optimized) only keeps the latest:
+	if (data.DynamicCollisionSubscriptionId != INDEX_NONE)
+		RemoveCollisionSubscription_Locked(data.DynamicCollisionSubscriptionId);
 
 #if WITH_EDITOR	
-	if (bRunDebugValidationsForDynamicCollisions && Volume->DynamicCollisionNotifyees.Contains(notifyee))
+	if (bRunDebugValidationsForDynamicCollisions)
 	{
-		FString errorMessage = FString::Printf(TEXT("ALERT: Navigator %s is attempting to add a duplicate collision listener to volume %d %d %d \n"), *task.Data.GetActorName(), Volume->X, Volume->Y, Volume->Z);
-		errorMessage += FString("This is usually a sign that you're not deregistering collision listeners after you're done using a navigation query.\n");
-		errorMessage += FString("Please ensure that _any_ code scheduling a navigation task even once _must_ clear all the collision listeners it acquires \n");
-		errorMessage += FString("after it is no longer interested in listening to dynamic collision along the requested path. This is also vital to maintain optimal performance.\n");
-		UE_LOG(DoNNavigationLog, Error, TEXT("%s"), *errorMessage);
+		for (const auto& existing : CollisionSubscriptions)
+		{
+			if (!(existing.Value.Listener == Task.DynamicCollisionListener))
+				continue;
+
+			FString errorMessage = FString::Printf(TEXT("ALERT: Navigator %s is attempting to add a duplicate collision listener (subscription %d is still active) \n"), *data.GetActorName(), existing.Key);
+			errorMessage += FString("This is usually a sign that you're not deregistering collision listeners after you're done using a navigation query.\n");
+			errorMessage += FString("Please ensure that _any_ code scheduling a navigation task even once _must_ clear all the collision listeners it acquires \n");
+			errorMessage += FString("after it is no longer interested in listening to dynamic collision along the requested path. This is also vital to maintain optimal performance.\n");
+			UE_LOG(DoNNavigationLog, Error, TEXT("%s"), *errorMessage);
+
+			break;
+		}
 	}
 #endif // WITH_EDITOR	
-	
-	
-	// Add dynamic listeners:
-	Volume->DynamicCollisionNotifyees.AddUnique(notifyee);	
 
-	if (task.Data.QueryParams.bPreciseDynamicCollisionRepathing)
+	const int32 subscriptionId = NextCollisionSubscriptionId++;
+
+	for (int32 voxelId : voxelIds)
+		CollisionSubscribersByVoxel.FindOrAdd(voxelId).Add(subscriptionId);
+
+	FDonCollisionSubscription& subscription = CollisionSubscriptions.Add(subscriptionId);
+	subscription.Listener = Task.DynamicCollisionListener;
+	subscription.CustomDelegatePayload = data.QueryParams.CustomDelegatePayload;
+	subscription.VoxelIds = MoveTemp(voxelIds);
+	subscription.PathVolumes = data.VolumeSolutionOptimized;
+	subscription.PathPointVolumeIndices = data.PathPointVolumeIndices;
+	subscription.VoxelCollisionProfile = data.VoxelCollisionProfile;
+	subscription.bPreciseDynamicCollisionRepathing = bPreciseDynamicCollisionRepathing;
+
+	data.DynamicCollisionSubscriptionId = subscriptionId;
+}
+
+void ADonNavigationManager::UnsubscribeFromDynamicCollisions(const FDonNavigationDynamicCollisionDelegate& Listener, int32 SubscriptionId)
+{
+	if (SubscriptionId == INDEX_NONE)
+		return;
+
+	FScopeLock lock(&CollisionSubscriptionLock);
+
+	const FDonCollisionSubscription* subscription = CollisionSubscriptions.Find(SubscriptionId);
+	if (subscription && subscription->Listener == Listener)
+		RemoveCollisionSubscription_Locked(SubscriptionId);
+}
+
+void ADonNavigationManager::RemoveCollisionSubscription_Locked(int32 SubscriptionId)
+{
+	FDonCollisionSubscription subscription;
+	if (CollisionSubscriptions.RemoveAndCopyValue(SubscriptionId, subscription))
+		RemoveCollisionSubscribers_Locked(SubscriptionId, subscription.VoxelIds);
+}
+
+void ADonNavigationManager::RemoveCollisionSubscribers_Locked(int32 SubscriptionId, const TArray<int32>& VoxelIds)
+{
+	for (int32 voxelId : VoxelIds)
+	{
+		FDonCollisionSubscriberList* subscribers = CollisionSubscribersByVoxel.Find(voxelId);
+		if (!subscribers)
+			continue;
+
+		subscribers->RemoveSingleSwap(SubscriptionId);
+
+		if (!subscribers->Num())
+			CollisionSubscribersByVoxel.Remove(voxelId);
+	}
+}
+
+void ADonNavigationManager::BroadcastCollisionUpdates(const TArray<FDonNavigationVoxel*>& OccupiedVolumes)
+{
+	// Collect the notifications under the lock but run them after releasing it, as listeners typically unsubscribe (and re-query) from their handlers:
+	TArray<FDonNavigationDynamicCollisionNotifyee> notifyees;
+
 	{
-		for (auto offset : task.Data.VoxelCollisionProfile.RelativeVoxelOccupancy)
+		FScopeLock lock(&CollisionSubscriptionLock);
+
+		// Group the occupied voxels by subscription. A voxel may be reported more than once per batch when several meshes overlap it.
+		TSet<int32> visitedVoxelIds;
+		TMap<int32, TArray<FDonNavigationVoxel*>> occupiedVolumesBySubscription;
+
+		for (auto volume : OccupiedVolumes)
 		{
-			auto volumeFromProfile = VolumeAtSafe(Volume->X + offset.X, Volume->Y + offset.Y, Volume->Z + offset.Z);
-			if (volumeFromProfile)
-			{
-				volumeFromProfile->DynamicCollisionNotifyees.AddUnique(notifyee);				
-			}
+			const int32 voxelId = VoxelIdFor(volume);
+
+			bool bAlreadyVisited = false;
+			visitedVoxelIds.Add(voxelId, &bAlreadyVisited);
+			if (bAlreadyVisited)
+				continue;
+
+			const FDonCollisionSubscriberList* subscribers = CollisionSubscribersByVoxel.Find(voxelId);
+			if (!subscribers)
+				continue;
+
+			for (int32 subscriptionId : *subscribers)
+				occupiedVolumesBySubscription.FindOrAdd(subscriptionId).Add(volume);
+		}
+
+		notifyees.Reserve(occupiedVolumesBySubscription.Num());
+
+		for (const auto& entry : occupiedVolumesBySubscription)
+		{
+			const FDonCollisionSubscription& subscription = CollisionSubscriptions.FindChecked(entry.Key);
+
+			TArray<int32> affectedPathIndices;
+			for (auto volume : entry.Value)
+				subscription.AppendPathIndicesWatching(volume, affectedPathIndices);
+
+			// Everything this subscription watches here is already behind the listener:
+			if (!affectedPathIndices.Num())
+				continue;
+
+			affectedPathIndices.Sort();
+			affectedPathIndices.SetNum(Algo::Unique(affectedPathIndices), EAllowShrinking::No);
+
+			notifyees.Add(FDonNavigationDynamicCollisionNotifyee(subscription.Listener, FDonNavigationDynamicCollisionPayload(subscription.CustomDelegatePayload, *entry.Value[0], MoveTemp(affectedPathIndices))));
 		}
 	}
+
+	for (const auto& notifyee : notifyees)
+		notifyee.Listener.ExecuteIfBound(notifyee.Payload);
 }
 
 FDonNavigationVoxel* ADonNavigationManager::AppendVolumeList(FVector Location, FDonNavigationQueryTask& task)
@@ -2942,34 +5382,20 @@ FDonNavigationVoxel* ADonNavigationManager::AppendVolumeList(FVector Location, F
 
 void ADonNavigationManager::AppendVolumeListFromRange(FVector Start, FVector End, FDonNavigationQueryTask& task)
 {
-	auto startVolume = VolumeAt(Start);
+	// Every voxel crossed from Start up to (but excluding) the voxel holding End, which the next segment of the path begins from:
 	auto endVolume = VolumeAt(End);
-	auto directionNormal = (End - Start).GetSafeNormal();
-	
-	float deltaX = (End.X - Start.X);
-	float deltaY = (End.Y - Start.Y);
-	float deltaZ = (End.Z - Start.Z);	
-	
-	int32 countX = FMath::Abs(deltaX / VoxelSize);
-	int32 countY = FMath::Abs(deltaY / VoxelSize);
-	int32 countZ = FMath::Abs(deltaZ / VoxelSize);
-
-	FVector current = Start;
-	int32 counter = 1;
-	int32 countMax = FMath::Max3(countX, countY, countZ);
+	auto& volumes = task.Data.VolumeSolutionOptimized;
 
-	if (countMax == 0)
-		return;
-
-	while ( counter <= countMax)
-	{	
-		AppendVolumeList(current, task);
+	ForEachVoxelAlongSegment(Start, End, [endVolume, &volumes](FDonNavigationVoxel* Volume)
+	{
+		if (Volume == endVolume)
+			return false;
 
-		float multiplier = (counter / (float)countMax);
-		current = Start + multiplier * FVector(deltaX, deltaY, deltaZ);
+		if (Volume)
+			volumes.Add(Volume);
 
-		counter++;
-	}
+		return true;
+	});
 }
 
 // AI Utility Functions
@@ -3050,9 +5476,15 @@ bool ADonNavigationManager::IsLocationBeneathLandscape(FVector Location, float L
 
 void ADonNavigationManager::VisualizeDynamicCollisionListeners(FDonNavigationDynamicCollisionDelegate Listener, UPARAM(ref) const FDoNNavigationQueryData& QueryData)
 {
+	FScopeLock lock(&CollisionSubscriptionLock);
+
+	const FDonCollisionSubscription* subscription = CollisionSubscriptions.Find(QueryData.DynamicCollisionSubscriptionId);
+	if (subscription && !(subscription->Listener == Listener))
+		subscription = NULL;
+
 	for (auto volume : QueryData.VolumeSolutionOptimized)
 	{	
-		bool bContainsListener = volume->DynamicCollisionNotifyees.ContainsByPredicate([&Listener](const FDonNavigationDynamicCollisionNotifyee& notifyee) {return notifyee.Listener == Listener; });
+		bool bContainsListener = subscription && Algo::BinarySearch(subscription->VoxelIds, VoxelIdFor(volume)) != INDEX_NONE;
 		if (bContainsListener)
 		{	
 			DrawDebugVoxel_Safe(GetWorld(), volume->Location, NavVolumeExtent(), FColor::Yellow, true, -1.f, 0, DebugVoxelsLineThickness);
@@ -3131,5 +5563,12 @@ void ADonNavigationManager::SetIsUnbound(bool bIsUnboundIn)
 	bIsUnbound = bIsUnboundIn;
 
 	RefreshPerformanceSettings();
+
+	// Finite and infinite worlds are looked up differently:
+	if (HasActorBegunPlay())
+	{
+		if (auto subsystem = UWorld::GetSubsystem<UDonNavigationSubsystem>(GetWorld()))
+			subsystem->RegisterManager(this);
+	}
 }
 
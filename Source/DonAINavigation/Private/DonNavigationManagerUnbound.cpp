@@ -67,6 +67,55 @@ bool ADonNavigationManagerUnbound::PrepareSolution(FDonNavigationQueryTask& Task
 	return originFound;
 }
 
+bool ADonNavigationManagerUnbound::PreparePartialSolution(FDonNavigationQueryTask& Task)
+{
+	if (!bIsUnbound)
+		return Super::PreparePartialSolution(Task);
+
+	auto& data = Task.Data;
+
+	// Find the explored location nearest to the destination, it must be closer than where we started from:
+	const FDonNavigationLocVector* nearestLocation = NULL;
+	float nearestDistSq = FVector::DistSquared(data.OriginVolumeCenter, data.Destination);
+
+	for (const auto& entry : data.VolumeVsCostMap_Unbound)
+	{
+		const float distSq = FVector::DistSquared(entry.Key, data.Destination);
+		if (distSq < nearestDistSq)
+		{
+			nearestDistSq = distSq;
+			nearestLocation = &entry.Key;
+		}
+	}
+
+	if (!nearestLocation)
+		return false;
+
+	data.PathSolutionRaw.Reset();
+	data.PathSolutionRaw.Add(*nearestLocation);
+
+	// Work our way back to the origin, same as PrepareSolution:
+	bool originFound = false;
+	auto nextLocation = data.VolumeVsGoalTrajectoryMap_Unbound.Find(*nearestLocation);
+
+	while (nextLocation)
+	{
+		if (data.PathSolutionRaw.Contains(*nextLocation))
+			break;
+
+		data.PathSolutionRaw.Insert((*nextLocation), 0);
+
+		if (*nextLocation == data.OriginVolumeCenter)
+		{
+			originFound = true;
+			break;
+		}
+
+		nextLocation = data.VolumeVsGoalTrajectoryMap_Unbound.Find(*nextLocation);
+	}
+
+	return originFound;
+}
 
 void ADonNavigationManagerUnbound::TickNavigationSolver(FDonNavigationQueryTask& task)
 {
@@ -81,6 +130,9 @@ void ADonNavigationManagerUnbound::TickNavigationSolver(FDonNavigationQueryTask&
 
 	data.SolverIterationCount++;
 
+	if (data.SearchCorridorExpansions.Num())
+		data.SearchCorridorExpansions.Last()++;
+
 	if (!data.Frontier_Unbound.empty())
 	{
 		// Move towards goal by fetching the "best neighbor" of the previous volume from the Frontier priority queue
@@ -168,6 +220,12 @@ void ADonNavigationManagerUnbound::ExpandFrontierTowardsTarget(FDonNavigationQue
 	if (!CanNavigateByCollisionProfile(Neighbor, Task.Data.VoxelCollisionProfile))
 		return;
 
+	if (Task.Data.IsOutsideSearchCorridor(Neighbor))
+	{
+		Task.Data.SearchCorridorBoundary_Unbound.Add(Current);
+		return;
+	}
+
 	float SegmentDist = VoxelSize;
 
 	uint32 newCost = *Task.Data.VolumeVsCostMap_Unbound.Find(Current) + SegmentDist;
@@ -0,0 +1,184 @@
+// The MIT License(MIT)
+//
+// Copyright(c) 2015 Venugopalan Sreedharan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), 
+// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+// and / or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "DonNavigationPathSpline.h"
+#include "DonAINavigationPrivatePCH.h"
+#include "Algo/BinarySearch.h"
+
+// Centripetal parameterization (alpha = 0.5): knot intervals grow with the square root of the chord length, which keeps the curve
+// free of cusps and self intersections even where a path's points are very unevenly spaced (as voxel paths with long straightened legs are)
+static float CentripetalKnotInterval(const FVector& A, const FVector& B)
+{
+	return FMath::Max(FMath::Sqrt(FVector::Dist(A, B)), KINDA_SMALL_NUMBER);
+}
+
+// Barry-Goldman evaluation of the span P1 -> P2 at Alpha [0..1]
+static FVector CentripetalCatmullRom(const FVector& P0, const FVector& P1, const FVector& P2, const FVector& P3, float Alpha)
+{
+	const float t0 = 0.f;
+	const float t1 = t0 + CentripetalKnotInterval(P0, P1);
+	const float t2 = t1 + CentripetalKnotInterval(P1, P2);
+	const float t3 = t2 + CentripetalKnotInterval(P2, P3);
+	const float t = FMath::Lerp(t1, t2, Alpha);
+
+	const FVector a1 = ((t1 - t) * P0 + (t - t0) * P1) / (t1 - t0);
+	const FVector a2 = ((t2 - t) * P1 + (t - t1) * P2) / (t2 - t1);
+	const FVector a3 = ((t3 - t) * P2 + (t - t2) * P3) / (t3 - t2);
+
+	const FVector b1 = ((t2 - t) * a1 + (t - t0) * a2) / (t2 - t0);
+	const FVector b2 = ((t3 - t) * a2 + (t - t1) * a3) / (t3 - t1);
+
+	return ((t2 - t) * b1 + (t - t1) * b2) / (t2 - t1);
+}
+
+void FDonNavigationPathSpline::Build(const TArray<FVector>& Points, int32 SamplesPerSpan, FSegmentTest IsSegmentClear)
+{
+	Samples.Reset();
+	Distances.Reset();
+	PointDistances.Reset();
+	NumStraightenedSpans = 0;
+
+	if (Points.Num() < 2)
+		return;
+
+	SamplesPerSpan = FMath::Max(SamplesPerSpan, 1);
+
+	Samples.Reserve((Points.Num() - 1) * SamplesPerSpan + 1);
+	Distances.Reserve((Points.Num() - 1) * SamplesPerSpan + 1);
+	PointDistances.Reserve(Points.Num());
+
+	Samples.Add(Points[0]);
+	Distances.Add(0.f);
+	PointDistances.Add(0.f);
+
+	TArray<FVector, TInlineAllocator<32>> span;
+
+	for (int32 i = 0; i < Points.Num() - 1; i++)
+	{
+		const FVector& p1 = Points[i];
+		const FVector& p2 = Points[i + 1];
+
+		if (p1.Equals(p2))
+		{
+			PointDistances.Add(Distances.Last());
+			continue;
+		}
+
+		// The end spans have no outer neighbor, mirror the inner one instead:
+		const FVector p0 = i > 0 ? Points[i - 1] : 2.f * p1 - p2;
+		const FVector p3 = i + 2 < Points.Num() ? Points[i + 2] : 2.f * p2 - p1;
+
+		span.Reset();
+
+		FVector previous = p1;
+		bool bSpanClear = true;
+
+		for (int32 s = 1; s <= SamplesPerSpan; s++)
+		{
+			const FVector sample = s == SamplesPerSpan ? p2 : CentripetalCatmullRom(p0, p1, p2, p3, float(s) / SamplesPerSpan);
+
+			if (!IsSegmentClear(previous, sample))
+			{
+				bSpanClear = false;
+				break;
+			}
+
+			span.Add(sample);
+			previous = sample;
+		}
+
+		// The straight segment is part of the original path and therefore known to be clear:
+		if (!bSpanClear)
+		{
+			span.Reset();
+			span.Add(p2);
+			NumStraightenedSpans++;
+		}
+
+		for (const FVector& sample : span)
+		{
+			Distances.Add(Distances.Last() + FVector::Dist(Samples.Last(), sample));
+			Samples.Add(sample);
+		}
+
+		PointDistances.Add(Distances.Last());
+	}
+
+	if (Samples.Num() < 2)
+	{
+		Samples.Reset();
+		Distances.Reset();
+		PointDistances.Reset();
+	}
+}
+
+int32 FDonNavigationPathSpline::FindSegment(float Distance) const
+{
+	const int32 upper = Algo::UpperBound(Distances, Distance);
+
+	return FMath::Clamp(upper - 1, 0, Samples.Num() - 2);
+}
+
+FVector FDonNavigationPathSpline::GetLocationAtDistance(float Distance) const
+{
+	if (!IsValid())
+		return Samples.Num() ? Samples[0] : FVector::ZeroVector;
+
+	Distance = FMath::Clamp(Distance, 0.f, GetLength());
+
+	const int32 i = FindSegment(Distance);
+	const float segmentLength = Distances[i + 1] - Distances[i];
+	const float alpha = segmentLength > 0.f ? (Distance - Distances[i]) / segmentLength : 0.f;
+
+	return FMath::Lerp(Samples[i], Samples[i + 1], alpha);
+}
+
+FVector FDonNavigationPathSpline::GetDirectionAtDistance(float Distance) const
+{
+	if (!IsValid())
+		return FVector::ZeroVector;
+
+	const int32 i = FindSegment(FMath::Clamp(Distance, 0.f, GetLength()));
+
+	return (Samples[i + 1] - Samples[i]).GetSafeNormal();
+}
+
+float FDonNavigationPathSpline::FindDistanceClosestTo(const FVector& Location, float StartDistance, float SearchLength) const
+{
+	if (!IsValid())
+		return 0.f;
+
+	StartDistance = FMath::Clamp(StartDistance, 0.f, GetLength());
+
+	const int32 first = FindSegment(StartDistance);
+	const int32 last = FindSegment(StartDistance + FMath::Max(SearchLength, 0.f));
+
+	float bestDistance = StartDistance;
+	float bestDistSq = TNumericLimits<float>::Max();
+
+	for (int32 i = first; i <= last; i++)
+	{
+		const FVector closest = FMath::ClosestPointOnSegment(Location, Samples[i], Samples[i + 1]);
+		const float distSq = FVector::DistSquared(Location, closest);
+
+		if (distSq < bestDistSq)
+		{
+			bestDistSq = distSq;
+			bestDistance = Distances[i] + FVector::Dist(Samples[i], closest);
+		}
+	}
+
+	// Never move backwards along the spline:
+	return FMath::Max(bestDistance, StartDistance);
+}
@@ -0,0 +1,90 @@
+// The MIT License(MIT)
+//
+// Copyright(c) 2015 Venugopalan Sreedharan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), 
+// to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+// and / or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "DonNavigationSubsystem.h"
+#include "DonAINavigationPrivatePCH.h"
+#include "DonNavigationManager.h"
+
+void UDonNavigationSubsystem::RegisterManager(ADonNavigationManager* Manager)
+{
+	if (!Manager)
+		return;
+
+	UnregisterManager(Manager);
+
+	if (Manager->bIsUnbound)
+	{
+		UnboundManagers.Add(Manager);
+		return;
+	}
+
+	const FVector origin = Manager->GetActorLocation();
+	const FVector extent = FVector(Manager->XGridSize, Manager->YGridSize, Manager->ZGridSize) * Manager->VoxelSize;
+
+	FBoundManagerEntry entry;
+	entry.Manager = Manager;
+	entry.Bounds = FBox(origin, origin + extent);
+
+	const double volume = entry.Bounds.GetVolume();
+	const int32 index = BoundManagers.IndexOfByPredicate([volume](const FBoundManagerEntry& Other) { return Other.Bounds.GetVolume() > volume; });
+
+	BoundManagers.Insert(entry, index == INDEX_NONE ? BoundManagers.Num() : index);
+}
+
+void UDonNavigationSubsystem::UnregisterManager(ADonNavigationManager* Manager)
+{
+	BoundManagers.RemoveAll([Manager](const FBoundManagerEntry& Entry) { return Entry.Manager == Manager || !Entry.Manager.IsValid(); });
+	UnboundManagers.RemoveAll([Manager](const TWeakObjectPtr<ADonNavigationManager>& Other) { return Other == Manager || !Other.IsValid(); });
+}
+
+ADonNavigationManager* UDonNavigationSubsystem::GetManagerForLocation(FVector Location) const
+{
+	// The cached bounds are only a prefilter: the manager itself has the final say (and may have been moved since it registered)
+	for (const auto& entry : BoundManagers)
+	{
+		if (entry.Bounds.IsInsideOrOn(Location) && entry.Manager.IsValid() && entry.Manager->IsLocationWithinNavigableWorld(Location))
+			return entry.Manager.Get();
+	}
+
+	for (const auto& entry : BoundManagers)
+	{
+		if (!entry.Bounds.IsInsideOrOn(Location) && entry.Manager.IsValid() && entry.Manager->IsLocationWithinNavigableWorld(Location))
+			return entry.Manager.Get();
+	}
+
+	for (const auto& manager : UnboundManagers)
+	{
+		if (manager.IsValid())
+			return manager.Get();
+	}
+
+	return NULL;
+}
+
+ADonNavigationManager* UDonNavigationSubsystem::GetAnyManager() const
+{
+	for (const auto& entry : BoundManagers)
+	{
+		if (entry.Manager.IsValid())
+			return entry.Manager.Get();
+	}
+
+	for (const auto& manager : UnboundManagers)
+	{
+		if (manager.IsValid())
+			return manager.Get();
+	}
+
+	return NULL;
+}
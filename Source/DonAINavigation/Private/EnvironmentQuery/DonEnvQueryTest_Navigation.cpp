@@ -18,6 +18,7 @@
 #include "../DonAINavigationPrivatePCH.h"
 
 #include "DonNavigationManager.h"
+#include "DonNavigationHelper.h"
 #include "AIController.h"
 #include "EnvironmentQuery/Items/EnvQueryItemType_VectorBase.h"
 #include "EnvironmentQuery/Contexts/EnvQueryContext_Querier.h"
@@ -58,15 +59,7 @@ void UDonEnvQueryTest_Navigation::RunTest(FEnvQueryInstance& QueryInstance) cons
 	BoolValue.BindData(QueryOwner, QueryInstance.QueryID);
 	bool bWantsValid = BoolValue.GetValue();
 
-	ADonNavigationManager * DonNav = nullptr;
-
-	for (TActorIterator<ADonNavigationManager> It(ownerActor->GetWorld(), ADonNavigationManager::StaticClass()); It; ++It) {
-		const ADonNavigationManager *NavMgr = *It;
-		if (NavMgr->IsLocationWithinNavigableWorld(ownerActor->GetActorLocation())) {
-			DonNav = *It;
-			break;
-		}
-	}
+	ADonNavigationManager * DonNav = UDonNavigationHelper::DonNavigationManagerForActor(ownerActor);
 
 	if (!DonNav)
 		return;
@@ -25,10 +25,12 @@ FDonNavigationWorker::FDonNavigationWorker()
 
 }
 
-FDonNavigationWorker::FDonNavigationWorker(ADonNavigationManager* Manager, int32 MaxPathSolverIterations, int32 MaxCollisionSolverIterations) 
+FDonNavigationWorker::FDonNavigationWorker(ADonNavigationManager* Manager, int32 MaxPathSolverIterations, int32 MaxCollisionSolverIterations, int32 MaxFlowFieldIterations, double PathSolverTimeBudget) 
 				     : Manager(Manager), 
 					   MaxPathSolverIterations(MaxPathSolverIterations),
-					   MaxCollisionSolverIterations(MaxCollisionSolverIterations)
+					   MaxCollisionSolverIterations(MaxCollisionSolverIterations),
+					   MaxFlowFieldIterations(MaxFlowFieldIterations),
+					   PathSolverTimeBudget(PathSolverTimeBudget)
 {	
 	Thread = FRunnableThread::Create(this, TEXT("DonNavigationWorker"), 0U, TPri_BelowNormal);
 }
@@ -70,6 +72,7 @@ uint32 FDonNavigationWorker::Run()
 			//Manager->ReceiveAsyncAbortRequests();
 			Manager->ReceiveAsyncNavigationTasks();
 			Manager->ReceiveAsyncCollisionTasks();
+			Manager->ReceiveAsyncFlowFieldTasks();
 
 			SolveNavigationTasks();
 		}
@@ -86,7 +89,9 @@ void FDonNavigationWorker::Stop()
 
 void FDonNavigationWorker::SolveNavigationTasks()
 {
-	Manager->TickScheduledPathfindingTasks_Safe(0.f, MaxPathSolverIterations);
+	Manager->TickScheduledPathfindingTasks_Safe(0.f, MaxPathSolverIterations, PathSolverTimeBudget);
 
 	Manager->TickScheduledCollisionTasks_Safe(0.f, MaxCollisionSolverIterations);
+
+	Manager->TickScheduledFlowFieldTasks_Safe(MaxFlowFieldIterations);
 }
\ No newline at end of file